@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+// --------------------------------------------------------
+// A single piece of bound state (a shader, an input layout).
+// Set returns false when the value is already bound.
+// --------------------------------------------------------
+template <typename T>
+class BoundValue
+{
+public:
+    bool Set(const T& newValue)
+    {
+        if (known && value == newValue) return false;
+
+        value = newValue;
+        known = true;
+        return true;
+    }
+
+    void Invalidate() { known = false; }
+
+private:
+    T value{};
+    bool known{};
+};
+
+// --------------------------------------------------------
+// Bindings of one kind (buffers, views, samplers) for one
+// pipeline stage. Requests are staged; Commit compares them
+// with what is bound and emits one range per run of
+// contiguous slots that actually changed. Slots that were
+// never bound, or were invalidated, always count as changed.
+// Free of any graphics API so it can be driven by a stub.
+// --------------------------------------------------------
+template <typename T, uint32_t SlotCount>
+class BindingSlots
+{
+public:
+    void Request(uint32_t slot, const T& value)
+    {
+        requested[slot] = value;
+        pending.set(slot);
+        pendingBegin = std::min(pendingBegin, slot);
+        pendingEnd = std::max(pendingEnd, slot + 1);
+    }
+
+    bool HasPending() const { return pendingBegin < pendingEnd; }
+
+    // emit(firstSlot, count, const T* values) for each changed run
+    template <typename Emit>
+    void Commit(Emit&& emit)
+    {
+        uint32_t slot = pendingBegin;
+        while (slot < pendingEnd)
+        {
+            if (!IsChanged(slot))
+            {
+                ++slot;
+                continue;
+            }
+
+            uint32_t first = slot;
+            for (; slot < pendingEnd && IsChanged(slot); ++slot)
+            {
+                bound[slot] = requested[slot];
+                known.set(slot);
+            }
+            emit(first, slot - first, &bound[first]);
+        }
+
+        pending.reset();
+        pendingBegin = SlotCount;
+        pendingEnd = 0;
+    }
+
+    // Forget what is bound, e.g. after the context was used directly
+    void Invalidate() { known.reset(); }
+
+private:
+    bool IsChanged(uint32_t slot) const
+    {
+        return pending.test(slot) && !(known.test(slot) && bound[slot] == requested[slot]);
+    }
+
+private:
+    std::array<T, SlotCount> bound{};
+    std::array<T, SlotCount> requested{};
+    std::bitset<SlotCount> pending;
+    std::bitset<SlotCount> known;
+    uint32_t pendingBegin{ SlotCount };
+    uint32_t pendingEnd{};
+};
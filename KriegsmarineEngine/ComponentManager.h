@@ -1,12 +1,18 @@
 #pragma once
 #include "Core.Definition.h"
 #include "IComponentManager.h"
+#include "MemoryBudget.h"
 
 //https://www.geeksforgeeks.org/sparse-set/
 //sparse set ̿Ͽ entity Ѵ.
 template <typename Component>
 class ComponentManager : public IComponentManager
 {
+public:
+    // component storage is charged to the ECS memory budget
+    using DenseArray = std::vector<int, BudgetAllocator<int, MemoryHeap::ECS>>;
+    using ComponentArray = std::vector<Component, BudgetAllocator<Component, MemoryHeap::ECS>>;
+
 public:
     void Add(Entity entity, const Component& component)
     {
@@ -38,10 +44,10 @@ public:
         return nullptr;
     }
 
-    const std::vector<int>& GetDense() const { return dense; } // Dense 迭 ȯ
-    const std::vector<Component>& GetComponents() const { return m_components; } // Component 迭 ȯ
+    const DenseArray& GetDense() const { return dense; } // Dense 迭 ȯ
+    const ComponentArray& GetComponents() const { return m_components; } // Component 迭 ȯ
 
 private:
-    std::vector<int> dense;
-    std::vector<Component> m_components;
+    DenseArray dense;
+    ComponentArray m_components;
 };
@@ -0,0 +1,98 @@
+#include "ConstantBufferRing.h"
+#include "Core.Memory.h"
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+ConstantBufferRing::ConstantBufferRing(ID3D11Device* device, ID3D11DeviceContext* deviceContext, uint32 capacity, uint32 frameLatency)
+    : deviceContext(deviceContext), allocator(AlignUp(capacity, OFFSET_ALIGNMENT), frameLatency)
+{
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+    if (deviceContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED ||
+        FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) ||
+        !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+    {
+        return;
+    }
+
+    // Only needed for the offset binds; the context keeps it alive
+    if (FAILED(deviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&deviceContext1)))
+    {
+        deviceContext1 = nullptr;
+        return;
+    }
+    deviceContext1->Release();
+
+    D3D11_BUFFER_DESC desc{};
+    desc.ByteWidth = static_cast<UINT>(allocator.GetCapacity());
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    if (FAILED(device->CreateBuffer(&desc, nullptr, &buffer)))
+    {
+        buffer = nullptr;
+        deviceContext1 = nullptr;
+    }
+}
+
+ConstantBufferRing::~ConstantBufferRing()
+{
+    Memory::SafeDelete(buffer);
+}
+
+ConstantBufferRing& ConstantBufferRing::ForContext(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+    // Created first, so the registry outlives the rings it points at
+    static FrameListenerRegistry& registry = FrameListenerRegistry::GetGlobal();
+    static std::mutex mutex;
+    static std::unordered_map<ID3D11DeviceContext*, std::unique_ptr<ConstantBufferRing>> rings;
+
+    std::lock_guard lock(mutex);
+    std::unique_ptr<ConstantBufferRing>& ring = rings[deviceContext];
+    if (!ring)
+    {
+        ring = std::make_unique<ConstantBufferRing>(device, deviceContext);
+        if (ring->IsSupported())
+        {
+            registry.Add(ring.get());
+        }
+    }
+    return *ring;
+}
+
+// --------------------------------------------------------
+// Copies size bytes of constant data into the ring
+//
+// data - The CPU side copy of the constant buffer
+// size - Its size in bytes; the bound range is rounded up
+//        to whole 256 byte blocks
+// --------------------------------------------------------
+ConstantBufferRing::Allocation ConstantBufferRing::Upload(const void* data, uint32 size)
+{
+    if (!buffer) return {};
+
+    uint32 alignedSize = static_cast<uint32>(AlignUp(size, OFFSET_ALIGNMENT));
+    RingAllocator::Allocation range = allocator.Allocate(alignedSize, OFFSET_ALIGNMENT);
+    if (!range.IsValid()) return {};
+
+    // The allocator never hands out a range the GPU may still
+    // read, so NO_OVERWRITE is always safe. DISCARD would throw
+    // away ranges written earlier this frame that bound shaders
+    // still point at; it is only used to initialize the buffer.
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    D3D11_MAP mapType = initialized ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+    if (FAILED(deviceContext->Map(buffer, 0, mapType, 0, &mapped))) return {};
+    initialized = true;
+
+    memcpy(static_cast<byte*>(mapped.pData) + range.offset, data, size);
+    deviceContext->Unmap(buffer, 0);
+
+    return { buffer, static_cast<UINT>(range.offset / CONSTANT_SIZE), alignedSize / CONSTANT_SIZE, frame };
+}
+
+void ConstantBufferRing::OnFrameBegin(uint64_t frameIndex)
+{
+    frame = frameIndex;
+    allocator.BeginFrame();
+}
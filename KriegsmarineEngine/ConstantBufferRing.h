@@ -0,0 +1,69 @@
+#pragma once
+#include "Core.Definition.h"
+#include "TypeDefinition.h"
+#include "RingAllocator.h"
+
+// --------------------------------------------------------
+// Per-frame ring of constant data in one large dynamic
+// buffer. Every upload is written once into the next free
+// range (Map with NO_OVERWRITE; DISCARD only for the first)
+// and bound with D3D11.1 constant buffer offsets, instead
+// of updating a default-usage buffer per shader.
+// The offset bookkeeping is RingAllocator's. ForContext's
+// rings are registered with the global frame listener
+// registry, so their space is reclaimed every frame; shaders
+// use them by default.
+// --------------------------------------------------------
+class ConstantBufferRing : public IFrameListener
+{
+public:
+    static constexpr uint32 DEFAULT_CAPACITY = 1024 * 1024;
+    // offsets and sizes are in 16 byte constants, multiples of 16 constants
+    static constexpr uint32 CONSTANT_SIZE = 16;
+    static constexpr uint32 OFFSET_ALIGNMENT = 256;
+
+    struct Allocation
+    {
+        ID3D11Buffer* Buffer{};
+        UINT FirstConstant{};
+        UINT NumConstants{};
+        uint64_t Frame{};
+
+        bool IsValid() const { return Buffer != nullptr; }
+    };
+
+public:
+    ConstantBufferRing(ID3D11Device* device, ID3D11DeviceContext* deviceContext,
+        uint32 capacity = DEFAULT_CAPACITY, uint32 frameLatency = RingAllocator::DEFAULT_FRAME_LATENCY);
+    ~ConstantBufferRing();
+
+    ConstantBufferRing(const ConstantBufferRing&) = delete;
+    ConstantBufferRing& operator=(const ConstantBufferRing&) = delete;
+
+    // One ring per context, created on first use; unsupported on
+    // deferred contexts, whose command lists each need a DISCARD
+    static ConstantBufferRing& ForContext(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+
+    // False when the device lacks constant buffer offsetting or
+    // NO_OVERWRITE maps on constant buffers; Upload always fails then
+    bool IsSupported() const { return buffer != nullptr; }
+
+    // Returns an invalid allocation when unsupported or full
+    Allocation Upload(const void* data, uint32 size);
+
+    void OnFrameBegin(uint64_t frameIndex) override;
+
+    uint64_t GetFrame() const { return frame; }
+    size_t GetUsedBytes() const { return allocator.GetUsedBytes(); }
+    ID3D11DeviceContext1* GetDeviceContext1() const { return deviceContext1; }
+
+private:
+    ID3D11DeviceContext* deviceContext;
+    // not AddRef'd, lives as long as deviceContext
+    ID3D11DeviceContext1* deviceContext1{};
+    ID3D11Buffer* buffer{};
+    RingAllocator allocator;
+    uint64_t frame{};
+    // The first Map discards, every later one is NO_OVERWRITE
+    bool initialized{};
+};
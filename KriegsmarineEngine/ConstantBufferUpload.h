@@ -0,0 +1,116 @@
+#pragma once
+#include "FrameListener.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------
+// Byte range of a constant buffer's CPU copy written since
+// its last upload. SetData grows it, uploads clear it.
+// --------------------------------------------------------
+struct ConstantBufferDirtyRange
+{
+    uint32_t Begin{ UINT32_MAX };
+    uint32_t End{};
+
+    void Mark(uint32_t offset, uint32_t size)
+    {
+        Begin = std::min(Begin, offset);
+        End = std::max(End, offset + size);
+    }
+
+    void MarkAll(uint32_t bufferSize) { Mark(0, bufferSize); }
+    void Clear() { Begin = UINT32_MAX; End = 0; }
+
+    bool IsDirty() const { return Begin < End; }
+};
+
+// --------------------------------------------------------
+// Constant buffer upload counters. Current frame counters
+// roll over into the last frame's on every frame boundary.
+// --------------------------------------------------------
+class ConstantBufferUploadStats : public IFrameListener
+{
+public:
+    struct Counters
+    {
+        uint64_t uploads{};
+        uint64_t skipped{};
+        uint64_t bytesUploaded{};
+    };
+
+public:
+    void RecordUpload(uint32_t bytes)
+    {
+        uploads.fetch_add(1, std::memory_order_relaxed);
+        bytesUploaded.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void RecordSkip() { skipped.fetch_add(1, std::memory_order_relaxed); }
+
+    void OnFrameBegin(uint64_t) override
+    {
+        lastFrame.uploads = uploads.exchange(0, std::memory_order_relaxed);
+        lastFrame.skipped = skipped.exchange(0, std::memory_order_relaxed);
+        lastFrame.bytesUploaded = bytesUploaded.exchange(0, std::memory_order_relaxed);
+    }
+
+    Counters GetCurrentFrame() const
+    {
+        return { uploads.load(std::memory_order_relaxed), skipped.load(std::memory_order_relaxed), bytesUploaded.load(std::memory_order_relaxed) };
+    }
+
+    Counters GetLastFrame() const { return lastFrame; }
+
+    // Rolled over by FrameListenerRegistry::GetGlobal(), which is created first so it outlives the stats
+    static ConstantBufferUploadStats& GetGlobal()
+    {
+        static FrameListenerRegistry& registry = FrameListenerRegistry::GetGlobal();
+        static ConstantBufferUploadStats stats;
+        [[maybe_unused]] static bool registered = (registry.Add(&stats), true);
+        return stats;
+    }
+
+private:
+    std::atomic<uint64_t> uploads{};
+    std::atomic<uint64_t> skipped{};
+    std::atomic<uint64_t> bytesUploaded{};
+    Counters lastFrame{};
+};
+
+// --------------------------------------------------------
+// Uploads the dirty part of a constant buffer and clears it.
+// Kept free of D3D so it can be driven by a recording stub.
+//
+// buffer - anything with Size and a ConstantBufferDirtyRange Dirty
+// partialUpdates - the device can update part of a constant
+//                  buffer (D3D11.1); otherwise the whole
+//                  buffer goes up
+// upload(offset, size) - performs the actual copy
+//
+// Returns the number of bytes uploaded, 0 for a clean buffer
+// --------------------------------------------------------
+template <typename Buffer, typename Upload>
+uint32_t UploadIfDirty(Buffer& buffer, bool partialUpdates, Upload&& upload, ConstantBufferUploadStats& stats = ConstantBufferUploadStats::GetGlobal())
+{
+    if (!buffer.Dirty.IsDirty())
+    {
+        stats.RecordSkip();
+        return 0;
+    }
+
+    uint32_t begin = 0;
+    uint32_t end = buffer.Size;
+    if (partialUpdates)
+    {
+        // partial constant buffer updates must cover whole 16 byte constants
+        begin = buffer.Dirty.Begin & ~15u;
+        end = std::min((buffer.Dirty.End + 15u) & ~15u, buffer.Size);
+    }
+
+    upload(begin, end - begin);
+    buffer.Dirty.Clear();
+
+    stats.RecordUpload(end - begin);
+    return end - begin;
+}
@@ -0,0 +1,183 @@
+#include "InputLayoutCache.h"
+#include <memory>
+
+namespace
+{
+    // FNV-1a, continued from a previous hash
+    uint64 HashBytes(uint64 hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64 HashValue(uint64 hash, const T& value)
+    {
+        return HashBytes(hash, &value, sizeof(T));
+    }
+}
+
+InputLayoutCache::InputLayoutCache(ID3D11Device* device) :
+    device(device)
+{
+}
+
+InputLayoutCache::~InputLayoutCache()
+{
+    Clear();
+}
+
+InputLayoutCache& InputLayoutCache::ForDevice(ID3D11Device* device)
+{
+    static std::mutex mutex;
+    static std::unordered_map<ID3D11Device*, std::unique_ptr<InputLayoutCache>> caches;
+
+    std::lock_guard lock(mutex);
+    std::unique_ptr<InputLayoutCache>& cache = caches[device];
+    if (!cache)
+    {
+        cache = std::make_unique<InputLayoutCache>(device);
+    }
+    return *cache;
+}
+
+// --------------------------------------------------------
+// Hashes every field, and the semantic names by content
+// (the pointers differ between shaders)
+// --------------------------------------------------------
+uint64 InputLayoutCache::Hash(const D3D11_INPUT_ELEMENT_DESC* elements, uint32 elementCount)
+{
+    uint64 hash = HashValue(14695981039346656037ull, elementCount);
+    for (uint32 i = 0; i < elementCount; i++)
+    {
+        const D3D11_INPUT_ELEMENT_DESC& element = elements[i];
+        std::string_view name = element.SemanticName ? element.SemanticName : "";
+
+        hash = HashBytes(hash, name.data(), name.size() + 1);
+        hash = HashValue(hash, element.SemanticIndex);
+        hash = HashValue(hash, element.Format);
+        hash = HashValue(hash, element.InputSlot);
+        hash = HashValue(hash, element.AlignedByteOffset);
+        hash = HashValue(hash, element.InputSlotClass);
+        hash = HashValue(hash, element.InstanceDataStepRate);
+    }
+    return hash;
+}
+
+bool InputLayoutCache::Matches(const Entry& entry, const D3D11_INPUT_ELEMENT_DESC* elements, uint32 elementCount)
+{
+    if (entry.elements.size() != elementCount) return false;
+
+    for (uint32 i = 0; i < elementCount; i++)
+    {
+        const Element& cached = entry.elements[i];
+        const D3D11_INPUT_ELEMENT_DESC& element = elements[i];
+        if (cached.SemanticName != (element.SemanticName ? element.SemanticName : "") ||
+            cached.SemanticIndex != element.SemanticIndex ||
+            cached.Format != element.Format ||
+            cached.InputSlot != element.InputSlot ||
+            cached.AlignedByteOffset != element.AlignedByteOffset ||
+            cached.InputSlotClass != element.InputSlotClass ||
+            cached.InstanceDataStepRate != element.InstanceDataStepRate)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ID3D11InputLayout* InputLayoutCache::Acquire(const D3D11_INPUT_ELEMENT_DESC* elements, uint32 elementCount, ID3DBlob* shaderBlob)
+{
+    uint64 hash = Hash(elements, elementCount);
+
+    // Held while creating too, so two loader threads never make the same layout
+    std::lock_guard lock(mutex);
+
+    auto [first, last] = entries.equal_range(hash);
+    for (auto it = first; it != last; ++it)
+    {
+        if (Matches(it->second, elements, elementCount))
+        {
+            ++stats.shared;
+            it->second.layout->AddRef();
+            return it->second.layout;
+        }
+    }
+
+    ID3D11InputLayout* layout{};
+    HRESULT hr = device->CreateInputLayout(
+        elements,
+        elementCount,
+        shaderBlob->GetBufferPointer(),
+        shaderBlob->GetBufferSize(),
+        &layout);
+    if (FAILED(hr))
+    {
+        return nullptr;
+    }
+
+    Entry entry;
+    entry.elements.reserve(elementCount);
+    for (uint32 i = 0; i < elementCount; i++)
+    {
+        const D3D11_INPUT_ELEMENT_DESC& element = elements[i];
+        entry.elements.push_back({
+            element.SemanticName ? element.SemanticName : "",
+            element.SemanticIndex,
+            element.Format,
+            element.InputSlot,
+            element.AlignedByteOffset,
+            element.InputSlotClass,
+            element.InstanceDataStepRate });
+    }
+    entry.layout = layout;
+    entries.emplace(hash, std::move(entry));
+
+    ++stats.created;
+    // One reference for the cache, one for the caller
+    layout->AddRef();
+    return layout;
+}
+
+uint32 InputLayoutCache::Trim()
+{
+    std::lock_guard lock(mutex);
+
+    uint32 released = 0;
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        // AddRef/Release report the count; 1 is the cache's own reference
+        ID3D11InputLayout* layout = it->second.layout;
+        layout->AddRef();
+        if (layout->Release() == 1)
+        {
+            layout->Release();
+            it = entries.erase(it);
+            ++released;
+            continue;
+        }
+        ++it;
+    }
+    return released;
+}
+
+void InputLayoutCache::Clear()
+{
+    std::lock_guard lock(mutex);
+    for (auto& [hash, entry] : entries)
+    {
+        entry.layout->Release();
+    }
+    entries.clear();
+}
+
+InputLayoutCache::Stats InputLayoutCache::GetStats() const
+{
+    std::lock_guard lock(mutex);
+    return stats;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "SimpleShaderDefine.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// --------------------------------------------------------
+// Input layouts shared between vertex shaders. The key is
+// the element list built from a shader's reflected inputs,
+// which holds both the input signature (semantics, formats)
+// and the slot configuration (per vertex or per instance),
+// so shaders with identical inputs get the same layout
+// object and RenderStateCache skips IASetInputLayout
+// between them.
+//
+// The cache keeps one reference to every layout; Trim
+// drops the ones nothing else uses, Clear all of them (do
+// that before releasing the device). Thread safe, so
+// shaders can be created on loader threads.
+// --------------------------------------------------------
+class InputLayoutCache
+{
+public:
+    struct Stats
+    {
+        uint64 created{};
+        uint64 shared{};
+    };
+
+public:
+    explicit InputLayoutCache(ID3D11Device* device);
+    ~InputLayoutCache();
+
+    InputLayoutCache(const InputLayoutCache&) = delete;
+    InputLayoutCache& operator=(const InputLayoutCache&) = delete;
+
+    // One cache per device, created on first use
+    static InputLayoutCache& ForDevice(ID3D11Device* device);
+
+    // The layout for the elements, created against shaderBlob's
+    // input signature if there is none yet. The caller gets its
+    // own reference (release it as usual); null on failure.
+    ID3D11InputLayout* Acquire(const D3D11_INPUT_ELEMENT_DESC* elements, uint32 elementCount, ID3DBlob* shaderBlob);
+
+    // Releases layouts only the cache holds. Returns how many.
+    uint32 Trim();
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    // D3D11_INPUT_ELEMENT_DESC with its own copy of the name
+    struct Element
+    {
+        std::string SemanticName;
+        UINT SemanticIndex{};
+        DXGI_FORMAT Format{};
+        UINT InputSlot{};
+        UINT AlignedByteOffset{};
+        D3D11_INPUT_CLASSIFICATION InputSlotClass{};
+        UINT InstanceDataStepRate{};
+    };
+
+    struct Entry
+    {
+        std::vector<Element> elements;
+        ID3D11InputLayout* layout{};
+    };
+
+    static uint64 Hash(const D3D11_INPUT_ELEMENT_DESC* elements, uint32 elementCount);
+    static bool Matches(const Entry& entry, const D3D11_INPUT_ELEMENT_DESC* elements, uint32 elementCount);
+
+private:
+    ID3D11Device* device;
+    mutable std::mutex mutex;
+    std::unordered_multimap<uint64, Entry> entries;
+    Stats stats;
+};
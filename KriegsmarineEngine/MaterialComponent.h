@@ -1,9 +1,8 @@
 #pragma once
 #include "Core.Definition.h"
-#include "Material.h"
-#include "Core.Memory.h"
+#include "ResourcePool.h"
 
 struct MaterialComponent
 {
-    SegmentedPointer<MaterialInstance> material{};
+    MaterialInstanceHandle material{};
 };
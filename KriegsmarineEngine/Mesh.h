@@ -1,6 +1,7 @@
 #pragma once
 #include "Core.Definition.h"
 #include "Core.Mathf.h"
+#include "Core.Memory.h"
 
 #include "assimp/Importer.hpp"
 #include "assimp/scene.h"
@@ -22,6 +23,34 @@ struct MeshData
 	Mathf::xMatrix localTransform{ XMMatrixIdentity() };
 	int parentIndex{ -1 };
 
+	MeshData() = default;
+
+	// Copies share the buffers, each holding its own reference
+	MeshData(const MeshData& other) :
+		vertexBuffer(other.vertexBuffer),
+		indexBuffer(other.indexBuffer),
+		indexCount(other.indexCount),
+		localTransform(other.localTransform),
+		parentIndex(other.parentIndex)
+	{
+		if (vertexBuffer) vertexBuffer->AddRef();
+		if (indexBuffer) indexBuffer->AddRef();
+	}
+
+	MeshData& operator=(const MeshData& other)
+	{
+		if (this != &other)
+		{
+			MeshData copy(other);
+			std::swap(vertexBuffer, copy.vertexBuffer);
+			std::swap(indexBuffer, copy.indexBuffer);
+			indexCount = other.indexCount;
+			localTransform = other.localTransform;
+			parentIndex = other.parentIndex;
+		}
+		return *this;
+	}
+
 	~MeshData()
 	{
 		Memory::SafeDelete(vertexBuffer);
@@ -1,9 +1,8 @@
 #pragma once
 #include "Core.Definition.h"
-#include "Mesh.h"
-#include "Core.Memory.h"
+#include "ResourcePool.h"
 
 struct MeshComponent
 {
-    SegmentedPointer<Mesh> mesh{};
+    MeshHandle mesh{};
 };
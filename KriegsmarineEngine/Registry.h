@@ -2,7 +2,10 @@
 #include "Core.Definition.h"
 #include "EntityManager.h"
 #include "ComponentManager.h"
+#include "ReaderWriterLock.h"
+#include "SmallVector.h"
 #include <typeindex>
+#include <shared_mutex>
 
 //https://en.cppreference.com/w/cpp/algorithm/set_intersection
 //https://en.cppreference.com/w/cpp/types/type_index
@@ -17,6 +20,7 @@ public:
     void DestroyEntity(Entity entity)
     {
         m_entityManager.DestroyEntity(entity);
+        std::shared_lock lock(m_managerLock);
         for (auto& [type, manager] : m_componentManagers)
         {
             manager->Remove(entity);
@@ -58,23 +62,37 @@ private:
     ComponentManager<Component>& GetOrCreateComponentManager()
     {
         auto type = std::type_index(typeid(Component));
-        if (m_componentManagers.find(type) == m_componentManagers.end())
         {
-            m_componentManagers[type] = std::make_unique<ComponentManager<Component>>();
+            // the manager map is almost only read, so lookups share the lock
+            std::shared_lock lock(m_managerLock);
+            auto it = m_componentManagers.find(type);
+            if (it != m_componentManagers.end())
+            {
+                return *static_cast<ComponentManager<Component>*>(it->second.get());
+            }
+        }
+
+        std::unique_lock lock(m_managerLock);
+        auto& manager = m_componentManagers[type];
+        if (!manager)
+        {
+            manager = std::make_unique<ComponentManager<Component>>();
         }
-        return *static_cast<ComponentManager<Component>*>(m_componentManagers[type].get());
+        return *static_cast<ComponentManager<Component>*>(manager.get());
     }
 
     template <typename... Components>
     std::vector<Entity> GetEntitiesWithComponents()
     {
         // Ʈ ڸ ,   dense 迭 ȿ ƼƼ 
-        std::vector<std::vector<Entity>> entityLists;
+        // temporaries stay inline for small views, only the returned list is a real allocation
+        using EntityList = SmallVector<Entity, 64>;
+        SmallVector<EntityList, sizeof...(Components)> entityLists;
 
         // Ʈ ƼƼ ID 
         ([&]() {
             const auto& manager = GetOrCreateComponentManager<Components>();
-            std::vector<Entity> entities;
+            EntityList entities;
             for (size_t i = 0; i < manager.GetDense().size(); ++i)
             {
                 if (manager.GetDense()[i] != -1)
@@ -95,10 +113,10 @@ private:
             });
 
         // ù ° Ʈ   
-        std::vector<Entity> result = entityLists[0];
+        EntityList result = std::move(entityLists[0]);
         for (size_t i = 1; i < entityLists.size(); ++i)
         {
-            std::vector<Entity> temp;
+            EntityList temp;
             std::set_intersection(result.begin(), result.end(),
                 entityLists[i].begin(), entityLists[i].end(), std::back_inserter(temp)
             );
@@ -108,11 +126,12 @@ private:
             if (result.empty()) break;
         }
 
-        return result;
+        return std::vector<Entity>(result.begin(), result.end());
     }
 
 private:
     EntityManager m_entityManager;
     std::unordered_map<std::type_index, std::unique_ptr<IComponentManager>> m_componentManagers;
+    mutable ReaderWriterLock m_managerLock;
 
 };
@@ -0,0 +1,266 @@
+#include "RenderStateCache.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    void SetConstantBuffers(ID3D11DeviceContext* context, SHADER_TYPE stage, UINT first, UINT count, ID3D11Buffer* const* buffers)
+    {
+        switch (stage)
+        {
+        case SHADER_TYPE::VERTEX_SHADER:   context->VSSetConstantBuffers(first, count, buffers); break;
+        case SHADER_TYPE::PIXEL_SHADER:    context->PSSetConstantBuffers(first, count, buffers); break;
+        case SHADER_TYPE::DOMAIN_SHADER:   context->DSSetConstantBuffers(first, count, buffers); break;
+        case SHADER_TYPE::HULL_SHADER:     context->HSSetConstantBuffers(first, count, buffers); break;
+        case SHADER_TYPE::GEOMETRY_SHADER: context->GSSetConstantBuffers(first, count, buffers); break;
+        case SHADER_TYPE::COMPUTE_SHADER:  context->CSSetConstantBuffers(first, count, buffers); break;
+        default: break;
+        }
+    }
+
+    void SetConstantBuffers1(ID3D11DeviceContext1* context, SHADER_TYPE stage, UINT first, UINT count,
+        ID3D11Buffer* const* buffers, const UINT* firstConstants, const UINT* numConstants)
+    {
+        switch (stage)
+        {
+        case SHADER_TYPE::VERTEX_SHADER:   context->VSSetConstantBuffers1(first, count, buffers, firstConstants, numConstants); break;
+        case SHADER_TYPE::PIXEL_SHADER:    context->PSSetConstantBuffers1(first, count, buffers, firstConstants, numConstants); break;
+        case SHADER_TYPE::DOMAIN_SHADER:   context->DSSetConstantBuffers1(first, count, buffers, firstConstants, numConstants); break;
+        case SHADER_TYPE::HULL_SHADER:     context->HSSetConstantBuffers1(first, count, buffers, firstConstants, numConstants); break;
+        case SHADER_TYPE::GEOMETRY_SHADER: context->GSSetConstantBuffers1(first, count, buffers, firstConstants, numConstants); break;
+        case SHADER_TYPE::COMPUTE_SHADER:  context->CSSetConstantBuffers1(first, count, buffers, firstConstants, numConstants); break;
+        default: break;
+        }
+    }
+
+    void SetShaderResources(ID3D11DeviceContext* context, SHADER_TYPE stage, UINT first, UINT count, ID3D11ShaderResourceView* const* views)
+    {
+        switch (stage)
+        {
+        case SHADER_TYPE::VERTEX_SHADER:   context->VSSetShaderResources(first, count, views); break;
+        case SHADER_TYPE::PIXEL_SHADER:    context->PSSetShaderResources(first, count, views); break;
+        case SHADER_TYPE::DOMAIN_SHADER:   context->DSSetShaderResources(first, count, views); break;
+        case SHADER_TYPE::HULL_SHADER:     context->HSSetShaderResources(first, count, views); break;
+        case SHADER_TYPE::GEOMETRY_SHADER: context->GSSetShaderResources(first, count, views); break;
+        case SHADER_TYPE::COMPUTE_SHADER:  context->CSSetShaderResources(first, count, views); break;
+        default: break;
+        }
+    }
+
+    void SetSamplers(ID3D11DeviceContext* context, SHADER_TYPE stage, UINT first, UINT count, ID3D11SamplerState* const* samplers)
+    {
+        switch (stage)
+        {
+        case SHADER_TYPE::VERTEX_SHADER:   context->VSSetSamplers(first, count, samplers); break;
+        case SHADER_TYPE::PIXEL_SHADER:    context->PSSetSamplers(first, count, samplers); break;
+        case SHADER_TYPE::DOMAIN_SHADER:   context->DSSetSamplers(first, count, samplers); break;
+        case SHADER_TYPE::HULL_SHADER:     context->HSSetSamplers(first, count, samplers); break;
+        case SHADER_TYPE::GEOMETRY_SHADER: context->GSSetSamplers(first, count, samplers); break;
+        case SHADER_TYPE::COMPUTE_SHADER:  context->CSSetSamplers(first, count, samplers); break;
+        default: break;
+        }
+    }
+}
+
+RenderStateCache::RenderStateCache(ID3D11DeviceContext* deviceContext) :
+    deviceContext(deviceContext)
+{
+    // Only needed for constant buffer offsets; the context keeps it alive
+    if (SUCCEEDED(deviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&deviceContext1)))
+    {
+        deviceContext1->Release();
+    }
+    else
+    {
+        deviceContext1 = nullptr;
+    }
+}
+
+RenderStateCache& RenderStateCache::ForContext(ID3D11DeviceContext* deviceContext)
+{
+    static std::mutex mutex;
+    static std::unordered_map<ID3D11DeviceContext*, std::unique_ptr<RenderStateCache>> caches;
+
+    std::lock_guard lock(mutex);
+    std::unique_ptr<RenderStateCache>& cache = caches[deviceContext];
+    if (!cache)
+    {
+        cache = std::make_unique<RenderStateCache>(deviceContext);
+    }
+    return *cache;
+}
+
+void RenderStateCache::SetInputLayout(ID3D11InputLayout* layout)
+{
+    ++stats.requested;
+    if (!inputLayout.Set(layout)) return;
+
+    deviceContext->IASetInputLayout(layout);
+    ++stats.applied;
+    ++stats.issued;
+}
+
+bool RenderStateCache::SetStageShader(SHADER_TYPE stage, ID3D11DeviceChild* shader)
+{
+    ++stats.requested;
+    if (!GetStage(stage).shader.Set(shader)) return false;
+
+    ++stats.applied;
+    ++stats.issued;
+    return true;
+}
+
+void RenderStateCache::SetShader(ID3D11VertexShader* shader)
+{
+    if (SetStageShader(SHADER_TYPE::VERTEX_SHADER, shader)) deviceContext->VSSetShader(shader, 0, 0);
+}
+
+void RenderStateCache::SetShader(ID3D11PixelShader* shader)
+{
+    if (SetStageShader(SHADER_TYPE::PIXEL_SHADER, shader)) deviceContext->PSSetShader(shader, 0, 0);
+}
+
+void RenderStateCache::SetShader(ID3D11DomainShader* shader)
+{
+    if (SetStageShader(SHADER_TYPE::DOMAIN_SHADER, shader)) deviceContext->DSSetShader(shader, 0, 0);
+}
+
+void RenderStateCache::SetShader(ID3D11HullShader* shader)
+{
+    if (SetStageShader(SHADER_TYPE::HULL_SHADER, shader)) deviceContext->HSSetShader(shader, 0, 0);
+}
+
+void RenderStateCache::SetShader(ID3D11GeometryShader* shader)
+{
+    if (SetStageShader(SHADER_TYPE::GEOMETRY_SHADER, shader)) deviceContext->GSSetShader(shader, 0, 0);
+}
+
+void RenderStateCache::SetShader(ID3D11ComputeShader* shader)
+{
+    if (SetStageShader(SHADER_TYPE::COMPUTE_SHADER, shader)) deviceContext->CSSetShader(shader, 0, 0);
+}
+
+void RenderStateCache::SetConstantBuffer(SHADER_TYPE stage, uint32 slot, const ConstantBufferBinding& binding)
+{
+    ++stats.requested;
+    GetStage(stage).constantBuffers.Request(slot, binding);
+}
+
+void RenderStateCache::SetShaderResource(SHADER_TYPE stage, uint32 slot, ID3D11ShaderResourceView* srv)
+{
+    ++stats.requested;
+    GetStage(stage).shaderResources.Request(slot, srv);
+}
+
+void RenderStateCache::SetSampler(SHADER_TYPE stage, uint32 slot, ID3D11SamplerState* samplerState)
+{
+    ++stats.requested;
+    GetStage(stage).samplers.Request(slot, samplerState);
+}
+
+// --------------------------------------------------------
+// Staged bindings go out first, so a view staged before the
+// UAV can't unbind it afterwards. Once the UAV is bound the
+// runtime has unbound any shader resource view of the same
+// resource, on any stage, without the cache seeing it.
+// --------------------------------------------------------
+void RenderStateCache::SetUnorderedAccessView(uint32 slot, ID3D11UnorderedAccessView* uav, UINT initialCount)
+{
+    CommitAll();
+
+    ++stats.requested;
+    deviceContext->CSSetUnorderedAccessViews(slot, 1, &uav, &initialCount);
+    ++stats.applied;
+    ++stats.issued;
+
+    for (StageState& state : stages)
+    {
+        state.shaderResources.Invalidate();
+    }
+}
+
+void RenderStateCache::Commit(SHADER_TYPE stage)
+{
+    if (batchDepth == 0)
+    {
+        CommitStage(stage);
+    }
+}
+
+void RenderStateCache::CommitAll()
+{
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        CommitStage(static_cast<SHADER_TYPE>(i));
+    }
+}
+
+// --------------------------------------------------------
+// Issues one call per run of changed slots. A run of
+// constant buffers is split where it switches between
+// whole buffers and ranges, which need the D3D11.1 call.
+// --------------------------------------------------------
+void RenderStateCache::CommitStage(SHADER_TYPE stage)
+{
+    StageState& state = GetStage(stage);
+
+    state.constantBuffers.Commit([&](uint32 first, uint32 count, const ConstantBufferBinding* bindings)
+        {
+            ID3D11Buffer* buffers[CONSTANT_BUFFER_SLOTS];
+            UINT firstConstants[CONSTANT_BUFFER_SLOTS];
+            UINT numConstants[CONSTANT_BUFFER_SLOTS];
+
+            uint32 i = 0;
+            while (i < count)
+            {
+                bool ranged = deviceContext1 && bindings[i].NumConstants != 0;
+                uint32 runCount = 0;
+                for (; i + runCount < count && (deviceContext1 && bindings[i + runCount].NumConstants != 0) == ranged; runCount++)
+                {
+                    buffers[runCount] = bindings[i + runCount].Buffer;
+                    firstConstants[runCount] = bindings[i + runCount].FirstConstant;
+                    numConstants[runCount] = bindings[i + runCount].NumConstants;
+                }
+
+                if (ranged)
+                    SetConstantBuffers1(deviceContext1, stage, first + i, runCount, buffers, firstConstants, numConstants);
+                else
+                    SetConstantBuffers(deviceContext, stage, first + i, runCount, buffers);
+
+                stats.applied += runCount;
+                ++stats.issued;
+                i += runCount;
+            }
+        });
+
+    state.shaderResources.Commit([&](uint32 first, uint32 count, ID3D11ShaderResourceView* const* views)
+        {
+            SetShaderResources(deviceContext, stage, first, count, views);
+            stats.applied += count;
+            ++stats.issued;
+        });
+
+    state.samplers.Commit([&](uint32 first, uint32 count, ID3D11SamplerState* const* samplers)
+        {
+            SetSamplers(deviceContext, stage, first, count, samplers);
+            stats.applied += count;
+            ++stats.issued;
+        });
+}
+
+// --------------------------------------------------------
+// Forgets everything that is bound, so the next request
+// for each piece of state reaches the context
+// --------------------------------------------------------
+void RenderStateCache::Invalidate()
+{
+    inputLayout.Invalidate();
+    for (StageState& state : stages)
+    {
+        state.shader.Invalidate();
+        state.constantBuffers.Invalidate();
+        state.shaderResources.Invalidate();
+        state.samplers.Invalidate();
+    }
+}
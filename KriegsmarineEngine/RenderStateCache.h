@@ -0,0 +1,120 @@
+#pragma once
+#include "SimpleShaderDefine.h"
+#include "BindingSlots.h"
+
+// --------------------------------------------------------
+// Sits between the shaders and a device context and keeps
+// what each stage has bound. Binds of state that is already
+// set are dropped, and constant buffers, shader resource
+// views and samplers in contiguous slots go out as a single
+// range call.
+//
+// Slot bindings are staged and go out on Commit. Single
+// binds made inside a Batch are held back until the batch
+// ends, so they can coalesce too.
+//
+// Anything that binds on the context directly (or calls
+// ClearState) must Invalidate the cache afterwards; compute
+// UAVs go through SetUnorderedAccessView instead.
+// --------------------------------------------------------
+class RenderStateCache
+{
+public:
+    static constexpr uint32 CONSTANT_BUFFER_SLOTS = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+    static constexpr uint32 SHADER_RESOURCE_SLOTS = D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT;
+    static constexpr uint32 SAMPLER_SLOTS = D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT;
+
+    struct ConstantBufferBinding
+    {
+        ID3D11Buffer* Buffer{};
+        UINT FirstConstant{};
+        UINT NumConstants{}; // 0 binds the whole buffer
+
+        bool operator==(const ConstantBufferBinding&) const = default;
+    };
+
+    // requested counts every bind asked for (one per slot),
+    // applied the ones that reached the context and issued
+    // the calls that carried them; one range call applies
+    // several slots
+    struct Stats
+    {
+        uint64 requested{};
+        uint64 applied{};
+        uint64 issued{};
+
+        uint64 GetElided() const { return requested - applied; }
+    };
+
+    class Batch
+    {
+    public:
+        explicit Batch(RenderStateCache& cache) : cache(cache) { ++cache.batchDepth; }
+        ~Batch() { if (--cache.batchDepth == 0) cache.CommitAll(); }
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        RenderStateCache& cache;
+    };
+
+private:
+    struct StageState
+    {
+        BoundValue<ID3D11DeviceChild*> shader;
+        BindingSlots<ConstantBufferBinding, CONSTANT_BUFFER_SLOTS> constantBuffers;
+        BindingSlots<ID3D11ShaderResourceView*, SHADER_RESOURCE_SLOTS> shaderResources;
+        BindingSlots<ID3D11SamplerState*, SAMPLER_SLOTS> samplers;
+    };
+
+public:
+    explicit RenderStateCache(ID3D11DeviceContext* deviceContext);
+
+    RenderStateCache(const RenderStateCache&) = delete;
+    RenderStateCache& operator=(const RenderStateCache&) = delete;
+
+    // One cache per context, created on first use
+    static RenderStateCache& ForContext(ID3D11DeviceContext* deviceContext);
+
+    void SetInputLayout(ID3D11InputLayout* inputLayout);
+    void SetShader(ID3D11VertexShader* shader);
+    void SetShader(ID3D11PixelShader* shader);
+    void SetShader(ID3D11DomainShader* shader);
+    void SetShader(ID3D11HullShader* shader);
+    void SetShader(ID3D11GeometryShader* shader);
+    void SetShader(ID3D11ComputeShader* shader);
+
+    // Staged until Commit
+    void SetConstantBuffer(SHADER_TYPE stage, uint32 slot, const ConstantBufferBinding& binding);
+    void SetShaderResource(SHADER_TYPE stage, uint32 slot, ID3D11ShaderResourceView* srv);
+    void SetSampler(SHADER_TYPE stage, uint32 slot, ID3D11SamplerState* samplerState);
+
+    // Not cached, it goes straight to the context. Binding a
+    // resource for writing unbinds its shader resource views
+    // on every stage, so those are forgotten here.
+    void SetUnorderedAccessView(uint32 slot, ID3D11UnorderedAccessView* uav, UINT initialCount);
+
+    // Issues the stage's staged bindings, unless a Batch is open
+    void Commit(SHADER_TYPE stage);
+    void CommitAll();
+
+    void Invalidate();
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = {}; }
+
+private:
+    bool SetStageShader(SHADER_TYPE stage, ID3D11DeviceChild* shader);
+    void CommitStage(SHADER_TYPE stage);
+    StageState& GetStage(SHADER_TYPE stage) { return stages[static_cast<size_t>(stage)]; }
+
+private:
+    ID3D11DeviceContext* deviceContext;
+    // not AddRef'd, lives as long as deviceContext
+    ID3D11DeviceContext1* deviceContext1{};
+    BoundValue<ID3D11InputLayout*> inputLayout;
+    std::array<StageState, static_cast<size_t>(SHADER_TYPE::COUNT)> stages;
+    uint32 batchDepth{};
+    Stats stats;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "Core.Definition.h"
+#include "ObjectPool.h"
+#include "Mesh.h"
+#include "Material.h"
+#include "Texture.h"
+
+using MeshHandle = Handle<Mesh>;
+using MaterialHandle = Handle<Material>;
+using MaterialInstanceHandle = Handle<MaterialInstance>;
+using TextureHandle = Handle<Texture>;
+
+// Owns every engine resource; components keep 4-byte handles into these pools
+class ResourcePool : public Singleton<ResourcePool>
+{
+private:
+	friend class Singleton;
+
+private:
+	ResourcePool() = default;
+	~ResourcePool() = default;
+
+public:
+	template <typename Resource, typename... Args>
+	Handle<Resource> Create(Args&&... args)
+	{
+		return GetPool<Resource>().Create(std::forward<Args>(args)...);
+	}
+
+	template <typename Resource>
+	void Destroy(Handle<Resource> handle)
+	{
+		GetPool<Resource>().Destroy(handle);
+	}
+
+	template <typename Resource>
+	Resource* Get(Handle<Resource> handle)
+	{
+		return GetPool<Resource>().Get(handle);
+	}
+
+	template <typename Resource>
+	ObjectPool<Resource>& GetPool()
+	{
+		if constexpr (std::is_same_v<Resource, Mesh>) return _meshes;
+		else if constexpr (std::is_same_v<Resource, Material>) return _materials;
+		else if constexpr (std::is_same_v<Resource, MaterialInstance>) return _materialInstances;
+		else if constexpr (std::is_same_v<Resource, Texture>) return _textures;
+		else static_assert(sizeof(Resource) == 0, "No pool for this resource type");
+	}
+
+private:
+	// declared first so textures are destroyed last, materials point at them
+	ObjectPool<Texture> _textures;
+	ObjectPool<Material> _materials;
+	ObjectPool<MaterialInstance> _materialInstances;
+	ObjectPool<Mesh> _meshes;
+};
+
+inline static auto& ResourcePools = ResourcePool::GetInstance();
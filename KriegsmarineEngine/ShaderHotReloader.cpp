@@ -0,0 +1,196 @@
+#include "ShaderHotReloader.h"
+#include "Core.Memory.h"
+
+ShaderHotReloader::Reload::~Reload()
+{
+    // Only left here when the reload never got to creating the shader
+    Memory::SafeDelete(blob);
+}
+
+ShaderHotReloader::ShaderHotReloader(const std::shared_ptr<DirectX11::DeviceResources>& resources, std::chrono::milliseconds settleTime) :
+    resources(resources),
+    deviceFreeThreaded(!(resources->GetD3DDevice()->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED)),
+    schedule(settleTime)
+{
+}
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+    workers.WaitIdle();
+}
+
+bool ShaderHotReloader::Watch(std::shared_ptr<ShaderResource> shader, const file::path& shaderFile,
+    std::string entryPoint, std::string profile, const D3D_SHADER_MACRO* defines, Factory factory)
+{
+    std::error_code error;
+    file::path path = file::absolute(shaderFile, error).lexically_normal();
+    if (error || !shader || !watcher.AddDirectory(path.parent_path()))
+    {
+        return false;
+    }
+
+    Target target;
+    target.shader = shader;
+    target.entryPoint = std::move(entryPoint);
+    target.profile = std::move(profile);
+    for (; defines && defines->Name; defines++)
+    {
+        target.defines.emplace_back(defines->Name, defines->Definition ? defines->Definition : "");
+    }
+    target.factory = std::move(factory);
+
+    bool compiled = target.entryPoint.empty();
+    schedule.Add(std::move(path), compiled, std::move(target));
+    return true;
+}
+
+void ShaderHotReloader::Unwatch(const ShaderResource* shader)
+{
+    schedule.RemoveIf([shader](const Schedule::Entry& entry)
+    {
+        return entry.target.shader.expired() || entry.target.shader.lock().get() == shader;
+    });
+}
+
+uint32 ShaderHotReloader::Update()
+{
+    auto now = std::chrono::steady_clock::now();
+    for (const file::path& changedFile : watcher.Poll())
+    {
+        schedule.MarkChanged(changedFile, now);
+    }
+
+    // A reload still running keeps its own reference
+    schedule.RemoveIf([](const Schedule::Entry& entry)
+    {
+        return entry.target.shader.expired();
+    });
+
+    uint32 swapped = 0;
+    for (Schedule::Entry& entry : schedule.GetEntries())
+    {
+        if (!entry.target.reload)
+        {
+            continue;
+        }
+
+        Reload& reload = *entry.target.reload;
+        if (reload.state.load(std::memory_order_acquire) == ReloadState::REFLECTED)
+        {
+            Create(reload);
+        }
+
+        ReloadState state = reload.state.load(std::memory_order_acquire);
+        if (state == ReloadState::LOADED)
+        {
+            std::shared_ptr<ShaderResource> shader = entry.target.shader.lock();
+            if (shader && shader->ReplaceWith(*reload.replacement))
+            {
+                ++reloadCount;
+                ++swapped;
+            }
+            // The replacement now holds the old shader, released here
+            entry.target.reload.reset();
+            schedule.Finish(entry);
+        }
+        else if (state == ReloadState::FAILED)
+        {
+            lastError = entry.file.string() + ": " + reload.errors;
+            entry.target.reload.reset();
+            schedule.Finish(entry);
+        }
+    }
+
+    schedule.StartDue(now, [this](Schedule::Entry& entry)
+    {
+        Start(entry);
+    });
+    return swapped;
+}
+
+// --------------------------------------------------------
+// Render thread: the shader object is made here, since its
+// constructor talks to the device context
+// --------------------------------------------------------
+void ShaderHotReloader::Start(Schedule::Entry& entry)
+{
+    auto reload = std::make_shared<Reload>();
+    reload->shaderFile = entry.file;
+    reload->entryPoint = entry.target.entryPoint;
+    reload->profile = entry.target.profile;
+    reload->defines = entry.target.defines;
+    reload->replacement = entry.target.factory();
+
+    entry.target.reload = reload;
+    workers.Submit([this, reload]
+    {
+        Build(*reload);
+    });
+}
+
+// --------------------------------------------------------
+// Worker thread: compile or read, reflect, and create the
+// shader too when the device allows it
+// --------------------------------------------------------
+void ShaderHotReloader::Build(Reload& reload)
+{
+    file::path reflectionFile;
+    if (reload.entryPoint.empty())
+    {
+        if (D3DReadFileToBlob(reload.shaderFile.c_str(), &reload.blob) != S_OK)
+        {
+            reload.blob = nullptr;
+            reload.errors = "could not read the file";
+            reload.state.store(ReloadState::FAILED, std::memory_order_release);
+            return;
+        }
+        reflectionFile = GetShaderReflectionPath(reload.shaderFile);
+    }
+    else
+    {
+        // Null terminated macro list; the strings live in the reload
+        std::vector<D3D_SHADER_MACRO> macros;
+        for (const auto& [name, definition] : reload.defines)
+        {
+            macros.push_back({ name.c_str(), definition.c_str() });
+        }
+        macros.push_back({ nullptr, nullptr });
+
+        reload.blob = ShaderResource::CompileShaderFile(reload.shaderFile, reload.entryPoint, reload.profile, macros.data(), &reload.errors);
+        if (!reload.blob)
+        {
+            reload.state.store(ReloadState::FAILED, std::memory_order_release);
+            return;
+        }
+    }
+
+    if (!ShaderResource::LoadReflection(reload.blob, reflectionFile, reload.reflection))
+    {
+        reload.errors = "could not reflect the shader";
+        reload.state.store(ReloadState::FAILED, std::memory_order_release);
+        return;
+    }
+
+    if (deviceFreeThreaded)
+    {
+        Create(reload);
+        return;
+    }
+    reload.state.store(ReloadState::REFLECTED, std::memory_order_release);
+}
+
+void ShaderHotReloader::Create(Reload& reload)
+{
+    // The replacement owns the blob from here on
+    bool loaded = reload.replacement && reload.replacement->LoadShaderBlob(reload.blob, std::move(reload.reflection));
+    if (reload.replacement)
+    {
+        reload.blob = nullptr;
+    }
+
+    if (!loaded)
+    {
+        reload.errors = "could not create the shader";
+    }
+    reload.state.store(loaded ? ReloadState::LOADED : ReloadState::FAILED, std::memory_order_release);
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "ShaderResource.h"
+#include "ShaderReloadSchedule.h"
+#include "FileWatcher.h"
+#include "FrameListener.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+// --------------------------------------------------------
+// Reloads shaders when their files change on disk:
+//
+//   reloader.Watch(litPS, L"Shaders/Lit.hlsl", "main", "ps_5_0", defines);
+//   reloader.Watch(skyVS, L"Shaders/SkyVS.cso");
+//
+// Source files are compiled with the defines they were
+// watched with, compiled files (no entry point) are read as
+// they are. When to reload what is up to a
+// ShaderReloadSchedule: a change to an include reloads every
+// source watched from the same directory.
+//
+// Compiling, reflecting and (with a free threaded device)
+// creating happen on a background thread into a new shader
+// object. Update, run at a frame boundary, then swaps that
+// into the watched shader with ReplaceWith, so existing
+// pointers and handles keep working and values set so far
+// are kept. A shader that fails to build is left as it was;
+// the compiler output is in GetLastError.
+// --------------------------------------------------------
+class ShaderHotReloader : public IFrameListener
+{
+public:
+    // Makes an empty shader of the watched one's class and configuration
+    using Factory = InplaceFunction<std::shared_ptr<ShaderResource>(), 32>;
+
+    // Editors may save in several writes; a file has to be quiet this long
+    static constexpr std::chrono::milliseconds DEFAULT_SETTLE_TIME{ 100 };
+
+public:
+    explicit ShaderHotReloader(const std::shared_ptr<DirectX11::DeviceResources>& resources,
+        std::chrono::milliseconds settleTime = DEFAULT_SETTLE_TIME);
+    ~ShaderHotReloader();
+
+    // Returns false if the file's directory can't be watched
+    // defines - null terminated, as for CompileShaderFile; copied
+    template <typename ShaderType>
+    bool Watch(const std::shared_ptr<ShaderType>& shader, const file::path& shaderFile,
+        const std::string& entryPoint = {}, const std::string& profile = {},
+        const D3D_SHADER_MACRO* defines = nullptr)
+    {
+        return Watch(shader, shaderFile, entryPoint, profile, defines, [resources = resources]
+        {
+            return std::shared_ptr<ShaderResource>(std::make_shared<ShaderType>(resources));
+        });
+    }
+    // For shaders that need constructor arguments (e.g. stream out)
+    bool Watch(std::shared_ptr<ShaderResource> shader, const file::path& shaderFile,
+        std::string entryPoint, std::string profile, const D3D_SHADER_MACRO* defines, Factory factory);
+    // Shaders that are destroyed are dropped without this
+    void Unwatch(const ShaderResource* shader);
+
+    // Picks up changes, starts reloads and swaps in the finished
+    // ones. Call it on the render thread. Returns the swap count.
+    uint32 Update();
+    void OnFrameBegin(uint64_t) override { Update(); }
+
+    uint32 GetReloadCount() const { return reloadCount; }
+    const std::string& GetLastError() const { return lastError; }
+
+private:
+    enum class ReloadState : uint32
+    {
+        RUNNING,
+        // Needs creating on the render thread (single threaded device)
+        REFLECTED,
+        LOADED,
+        FAILED,
+    };
+
+    // Owned copies of a shader's macro names and values
+    using Defines = std::vector<std::pair<std::string, std::string>>;
+
+    // One reload in flight, shared with the worker
+    struct Reload
+    {
+        ~Reload();
+
+        file::path shaderFile;
+        std::string entryPoint;
+        std::string profile;
+        Defines defines;
+        std::shared_ptr<ShaderResource> replacement;
+
+        ID3DBlob* blob{};
+        ShaderReflectionData reflection;
+        std::string errors;
+        std::atomic<ReloadState> state{ ReloadState::RUNNING };
+    };
+
+    struct Target
+    {
+        std::weak_ptr<ShaderResource> shader;
+        std::string entryPoint;
+        std::string profile;
+        Defines defines;
+        Factory factory;
+
+        std::shared_ptr<Reload> reload;
+    };
+    using Schedule = ShaderReloadSchedule<Target>;
+
+    void Start(Schedule::Entry& entry);
+    void Build(Reload& reload);
+    void Create(Reload& reload);
+
+private:
+    std::shared_ptr<DirectX11::DeviceResources> resources;
+    bool deviceFreeThreaded{};
+
+    FileWatcher watcher;
+    Schedule schedule;
+
+    uint32 reloadCount{};
+    std::string lastError;
+
+    // Last, so the thread stops before anything it uses goes away
+    WorkerPool workers{ 1 };
+};
@@ -0,0 +1,114 @@
+#include "ShaderLoader.h"
+#include "Core.Memory.h"
+
+ShaderLoader::ShaderLoader(const std::shared_ptr<DirectX11::DeviceResources>& resources, uint32 workerCount) :
+    resources(resources),
+    deviceFreeThreaded(!(resources->GetD3DDevice()->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED)),
+    workers(workerCount)
+{
+}
+
+ShaderLoader::~ShaderLoader()
+{
+    WaitAll();
+}
+
+void ShaderLoader::Submit(std::shared_ptr<ShaderResource> shader, file::path shaderFile, Completion complete)
+{
+    auto job = std::make_shared<Job>();
+    job->shader = std::move(shader);
+    job->shaderFile = std::move(shaderFile);
+    job->complete = std::move(complete);
+
+    requested.fetch_add(1);
+    workers.Submit([this, job]
+    {
+        Read(*job);
+        if (!job->blob) return;
+
+        if (deviceFreeThreaded)
+        {
+            Create(*job);
+            return;
+        }
+
+        std::lock_guard lock(pendingMutex);
+        pendingCreates.push_back(job);
+    });
+}
+
+// --------------------------------------------------------
+// Worker side: file and reflection, no device calls
+// --------------------------------------------------------
+void ShaderLoader::Read(Job& job)
+{
+    if (D3DReadFileToBlob(job.shaderFile.c_str(), &job.blob) != S_OK)
+    {
+        job.blob = nullptr;
+        Finish(job, false);
+        return;
+    }
+
+    if (!ShaderResource::LoadReflection(job.blob, GetShaderReflectionPath(job.shaderFile), job.reflection))
+    {
+        Memory::SafeDelete(job.blob);
+        Finish(job, false);
+        return;
+    }
+
+    read.fetch_add(1);
+}
+
+void ShaderLoader::Create(Job& job)
+{
+    // The shader owns the blob from here on, loaded or not
+    bool shaderLoaded = job.shader->LoadShaderBlob(job.blob, std::move(job.reflection));
+    job.blob = nullptr;
+    Finish(job, shaderLoaded);
+}
+
+void ShaderLoader::Finish(Job& job, bool shaderLoaded)
+{
+    (shaderLoaded ? loaded : failed).fetch_add(1);
+
+    job.complete(shaderLoaded);
+    job.complete = nullptr;
+    job.shader.reset();
+}
+
+uint32 ShaderLoader::CreatePending(uint32 maxCount)
+{
+    uint32 created = 0;
+    while (created < maxCount)
+    {
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard lock(pendingMutex);
+            if (pendingCreates.empty()) break;
+
+            job = std::move(pendingCreates.front());
+            pendingCreates.pop_front();
+        }
+
+        Create(*job);
+        ++created;
+    }
+    return created;
+}
+
+void ShaderLoader::WaitAll()
+{
+    workers.WaitIdle();
+    CreatePending();
+}
+
+ShaderLoadProgress ShaderLoader::GetProgress() const
+{
+    // Finished counts first, so they never exceed the request count
+    ShaderLoadProgress progress;
+    progress.Failed = failed.load();
+    progress.Loaded = loaded.load();
+    progress.Read = read.load();
+    progress.Requested = requested.load();
+    return progress;
+}
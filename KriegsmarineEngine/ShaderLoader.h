@@ -0,0 +1,106 @@
+#pragma once
+#include "ShaderResource.h"
+#include "FrameListener.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <future>
+
+struct ShaderLoadProgress
+{
+    uint32 Requested{};
+    // Files read and reflected, waiting for or past creation
+    uint32 Read{};
+    uint32 Loaded{};
+    uint32 Failed{};
+
+    bool IsDone() const { return Loaded + Failed == Requested; }
+    float GetFraction() const { return Requested ? float(Loaded + Failed) / Requested : 1.0f; }
+};
+
+// --------------------------------------------------------
+// Loads compiled shaders in the background. Worker threads
+// read each file and get its reflection (sidecar or
+// D3DReflect); the device objects are then created right
+// there when the device is free threaded, or queued for
+// CreatePending on the device thread when it was created
+// with D3D11_CREATE_DEVICE_SINGLETHREADED.
+//
+//   auto ps = loader.Load<SimplePixelShader>(L"Lit.cso");
+//   ...
+//   if (loader.GetProgress().IsDone()) ps.get()->SetShader();
+//
+// A future holds the shader, or null if it failed to load.
+// With a single threaded device, don't wait on a future from
+// the device thread before CreatePending has run for it.
+// --------------------------------------------------------
+class ShaderLoader : public IFrameListener
+{
+public:
+    template <typename ShaderType>
+    using Future = std::shared_future<std::shared_ptr<ShaderType>>;
+
+public:
+    // workerCount 0 uses one thread per core but the caller's
+    explicit ShaderLoader(const std::shared_ptr<DirectX11::DeviceResources>& resources, uint32 workerCount = 0);
+    // Finishes every load, creating queued ones on the calling thread
+    ~ShaderLoader();
+
+    template <typename ShaderType>
+    Future<ShaderType> Load(file::path shaderFile)
+    {
+        // Constructed here, the constructor talks to the device context
+        auto shader = std::make_shared<ShaderType>(resources);
+        auto promise = std::make_shared<std::promise<std::shared_ptr<ShaderType>>>();
+        Future<ShaderType> future = promise->get_future().share();
+
+        Submit(shader, std::move(shaderFile), [shader, promise](bool loaded)
+        {
+            promise->set_value(loaded ? shader : nullptr);
+        });
+        return future;
+    }
+
+    // Creates the device objects of loads that finished reading;
+    // only needed with a single threaded device. Returns the count.
+    uint32 CreatePending(uint32 maxCount = UINT32_MAX);
+    void OnFrameBegin(uint64_t) override { CreatePending(); }
+
+    // Blocks until every load so far is done, creating queued ones
+    // on the calling thread (which must then be the device thread)
+    void WaitAll();
+
+    ShaderLoadProgress GetProgress() const;
+    bool IsDeviceFreeThreaded() const { return deviceFreeThreaded; }
+
+private:
+    using Completion = InplaceFunction<void(bool), 32>;
+
+    struct Job
+    {
+        std::shared_ptr<ShaderResource> shader;
+        file::path shaderFile;
+        ID3DBlob* blob{};
+        ShaderReflectionData reflection;
+        Completion complete;
+    };
+
+    void Submit(std::shared_ptr<ShaderResource> shader, file::path shaderFile, Completion complete);
+    void Read(Job& job);
+    void Create(Job& job);
+    void Finish(Job& job, bool loaded);
+
+private:
+    std::shared_ptr<DirectX11::DeviceResources> resources;
+    bool deviceFreeThreaded{};
+
+    std::atomic<uint32> requested{};
+    std::atomic<uint32> read{};
+    std::atomic<uint32> loaded{};
+    std::atomic<uint32> failed{};
+
+    std::mutex pendingMutex;
+    std::deque<std::shared_ptr<Job>> pendingCreates;
+
+    // Last, so the threads stop before anything they use goes away
+    WorkerPool workers;
+};
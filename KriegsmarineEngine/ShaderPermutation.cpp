@@ -0,0 +1,35 @@
+#include "ShaderPermutation.h"
+
+ID3DBlob* LoadOrCompilePermutation(
+    const file::path& sourceFile,
+    const std::string& entryPoint,
+    const std::string& profile,
+    const ShaderDefineTable& defines,
+    ShaderPermutationKey key,
+    const file::path& cacheFile)
+{
+    ID3DBlob* blob{};
+    if (IsShaderCacheCurrent(cacheFile, sourceFile) &&
+        D3DReadFileToBlob(cacheFile.c_str(), &blob) == S_OK)
+    {
+        return blob;
+    }
+
+    // Null terminated macro list; names stay alive in the define table
+    std::vector<D3D_SHADER_MACRO> macros;
+    defines.ForEachDefine(key, [&macros](const std::string& name)
+    {
+        macros.push_back({ name.c_str(), "1" });
+    });
+    macros.push_back({ nullptr, nullptr });
+
+    blob = ShaderResource::CompileShaderFile(sourceFile, entryPoint, profile, macros.data());
+    if (!blob)
+    {
+        return nullptr;
+    }
+
+    // Best effort, the next run just compiles again
+    D3DWriteBlobToFile(blob, cacheFile.c_str(), TRUE);
+    return blob;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "ShaderPermutationKey.h"
+#include "SimpleShader.h"
+
+// --------------------------------------------------------
+// Compiled code of one permutation. Reuses cacheFile when it
+// is newer than the source, otherwise compiles the source
+// with the key's defines (each one defined as "1") and
+// writes the result to cacheFile for next time.
+//
+// Returns null if the source doesn't compile; the caller
+// owns the returned blob.
+// --------------------------------------------------------
+ID3DBlob* LoadOrCompilePermutation(
+    const file::path& sourceFile,
+    const std::string& entryPoint,
+    const std::string& profile,
+    const ShaderDefineTable& defines,
+    ShaderPermutationKey key,
+    const file::path& cacheFile);
+
+// --------------------------------------------------------
+// All variants of one shader source, loaded on first use:
+//
+//   ShaderPermutationSet<SimplePixelShader> lit(resources,
+//       L"Lit.hlsl", "main", "ps_5_0", L"ShaderCache");
+//   uint32 normalMap = lit.AddDefine("NORMAL_MAP");
+//   lit.Get(1ull << normalMap)->SetShader();
+//
+// Blobs are cached on disk as
+// "<cache>/<source>.<entry>.<profile>.<defines>.<key>.cso",
+// where <defines> is the define table's hash, since a key's
+// bits only mean something with the same defines in the same
+// order. The reflection sidecar sits next to each blob.
+// Variants whose constant buffers, textures and samplers lay
+// out the same share one ShaderReflectionTable. At most
+// maxResident variants are kept loaded; a variant still
+// referenced elsewhere outlives its eviction.
+// --------------------------------------------------------
+template <typename ShaderType>
+class ShaderPermutationSet
+{
+public:
+    static constexpr size_t DEFAULT_MAX_RESIDENT = 32;
+
+public:
+    ShaderPermutationSet(
+        const std::shared_ptr<DirectX11::DeviceResources>& resources,
+        file::path sourceFile,
+        std::string entryPoint,
+        std::string profile,
+        file::path cacheDirectory,
+        size_t maxResident = DEFAULT_MAX_RESIDENT) :
+        resources(resources),
+        sourceFile(std::move(sourceFile)),
+        entryPoint(std::move(entryPoint)),
+        profile(std::move(profile)),
+        cacheDirectory(std::move(cacheDirectory)),
+        variants(maxResident)
+    {
+    }
+
+    // Bit for the define, to be or-ed into keys; ShaderDefineTable::INVALID_BIT past 64 defines
+    uint32 AddDefine(const std::string& name) { return defines.Add(name); }
+    const ShaderDefineTable& GetDefines() const { return defines; }
+
+    // The loaded variant, or null if it fails to compile or load.
+    // Failures are remembered so a broken variant isn't compiled every frame.
+    std::shared_ptr<ShaderType> Get(ShaderPermutationKey key)
+    {
+        if (std::shared_ptr<ShaderType>* variant = variants.Find(key))
+        {
+            return *variant;
+        }
+
+        std::shared_ptr<ShaderType> variant = Load(key);
+        return variants.Insert(key, std::move(variant));
+    }
+
+    // Drops every loaded variant, e.g. after the source changed
+    void Clear() { variants.Clear(); }
+
+    file::path GetCachePath(ShaderPermutationKey key) const
+    {
+        file::path path = cacheDirectory / sourceFile.stem();
+        path += "." + entryPoint + "." + profile;
+        path += "." + FormatPermutationKey(defines.GetHash());
+        path += "." + FormatPermutationKey(key) + ".cso";
+        return path;
+    }
+
+private:
+    std::shared_ptr<ShaderType> Load(ShaderPermutationKey key)
+    {
+        if (!defines.IsValidKey(key)) return nullptr;
+
+        std::error_code error;
+        file::create_directories(cacheDirectory, error);
+
+        file::path cachePath = GetCachePath(key);
+        ID3DBlob* blob = LoadOrCompilePermutation(sourceFile, entryPoint, profile, defines, key, cachePath);
+        if (!blob) return nullptr;
+
+        auto shader = std::make_shared<ShaderType>(resources);
+        if (!shader->LoadShaderBlob(blob, GetShaderReflectionPath(cachePath)))
+        {
+            return nullptr;
+        }
+        return shader;
+    }
+
+private:
+    std::shared_ptr<DirectX11::DeviceResources> resources;
+    file::path sourceFile;
+    std::string entryPoint;
+    std::string profile;
+    file::path cacheDirectory;
+
+    ShaderDefineTable defines;
+    ShaderVariantCache<std::shared_ptr<ShaderType>> variants;
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --------------------------------------------------------
+// A shader permutation is one compile of a source file with
+// some set of boolean defines (NORMAL_MAP, SKINNED, ...).
+// Each define a shader knows is given one bit, so a variant
+// is named by a 64 bit key. Free of D3D types.
+// --------------------------------------------------------
+using ShaderPermutationKey = uint64_t;
+
+class ShaderDefineTable
+{
+public:
+    static constexpr uint32_t MAX_DEFINES = 64;
+    static constexpr uint32_t INVALID_BIT = UINT32_MAX;
+
+public:
+    // Returns the define's bit (the existing one if it was added
+    // before), or INVALID_BIT when the table is full
+    uint32_t Add(const std::string& name)
+    {
+        uint32_t bit = GetBit(name);
+        if (bit != INVALID_BIT) return bit;
+        if (names.size() == MAX_DEFINES) return INVALID_BIT;
+
+        names.push_back(name);
+        return static_cast<uint32_t>(names.size() - 1);
+    }
+
+    uint32_t GetBit(const std::string& name) const
+    {
+        for (uint32_t bit = 0; bit < names.size(); bit++)
+        {
+            if (names[bit] == name) return bit;
+        }
+        return INVALID_BIT;
+    }
+
+    // Unknown names are ignored
+    ShaderPermutationKey MakeKey(std::initializer_list<std::string> defines) const
+    {
+        ShaderPermutationKey key{};
+        for (const std::string& name : defines)
+        {
+            uint32_t bit = GetBit(name);
+            if (bit != INVALID_BIT) key |= ShaderPermutationKey(1) << bit;
+        }
+        return key;
+    }
+
+    // fn(const std::string& name) for every define set in the key, in bit order
+    template <typename Fn>
+    void ForEachDefine(ShaderPermutationKey key, Fn&& fn) const
+    {
+        for (uint32_t bit = 0; bit < names.size(); bit++)
+        {
+            if (key & (ShaderPermutationKey(1) << bit)) fn(names[bit]);
+        }
+    }
+
+    // Keys with bits of defines that were never added
+    bool IsValidKey(ShaderPermutationKey key) const
+    {
+        return names.size() == MAX_DEFINES || (key >> names.size()) == 0;
+    }
+
+    const std::string& GetName(uint32_t bit) const { return names[bit]; }
+    uint32_t GetCount() const { return static_cast<uint32_t>(names.size()); }
+
+    // FNV-1a over the names in bit order. Keys only mean the same
+    // variant between tables with the same hash.
+    uint64_t GetHash() const
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const std::string& name : names)
+        {
+            // the terminator keeps {"AB"} and {"A", "B"} apart
+            for (size_t i = 0; i <= name.size(); i++)
+            {
+                hash ^= static_cast<uint8_t>(name.c_str()[i]);
+                hash *= 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+private:
+    std::vector<std::string> names;
+};
+
+// Fixed width lowercase hex, for cache file names
+inline std::string FormatPermutationKey(ShaderPermutationKey key)
+{
+    constexpr char digits[] = "0123456789abcdef";
+
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; i--)
+    {
+        text[i] = digits[key & 0xF];
+        key >>= 4;
+    }
+    return text;
+}
+
+// A compiled blob on disk is reused while it is at least as new
+// as the source. Includes of the source are not tracked.
+inline bool IsShaderCacheCurrent(const std::filesystem::path& cacheFile, const std::filesystem::path& sourceFile)
+{
+    std::error_code error;
+    auto cacheTime = std::filesystem::last_write_time(cacheFile, error);
+    if (error) return false;
+
+    auto sourceTime = std::filesystem::last_write_time(sourceFile, error);
+    if (error) return false;
+
+    return cacheTime >= sourceTime;
+}
+
+// --------------------------------------------------------
+// Loaded variants by key, least recently used first out.
+// Evicted values are only dropped from the cache; whoever
+// still holds one (a shared_ptr, say) keeps it alive.
+// --------------------------------------------------------
+template <typename V>
+class ShaderVariantCache
+{
+public:
+    explicit ShaderVariantCache(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    // Marks the entry as most recently used; null if it isn't cached
+    V* Find(ShaderPermutationKey key)
+    {
+        auto it = entries.find(key);
+        if (it == entries.end()) return nullptr;
+
+        order.splice(order.begin(), order, it->second.position);
+        return &it->second.value;
+    }
+
+    // Replaces an existing entry for the key. Returns the cached value.
+    V& Insert(ShaderPermutationKey key, V value)
+    {
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            it->second.value = std::move(value);
+            order.splice(order.begin(), order, it->second.position);
+            return it->second.value;
+        }
+
+        while (entries.size() >= capacity)
+        {
+            entries.erase(order.back());
+            order.pop_back();
+        }
+
+        order.push_front(key);
+        Entry& entry = entries[key];
+        entry.value = std::move(value);
+        entry.position = order.begin();
+        return entry.value;
+    }
+
+    void Erase(ShaderPermutationKey key)
+    {
+        auto it = entries.find(key);
+        if (it == entries.end()) return;
+
+        order.erase(it->second.position);
+        entries.erase(it);
+    }
+
+    void Clear()
+    {
+        entries.clear();
+        order.clear();
+    }
+
+    size_t GetSize() const { return entries.size(); }
+    size_t GetCapacity() const { return capacity; }
+
+private:
+    struct Entry
+    {
+        V value{};
+        typename std::list<ShaderPermutationKey>::iterator position;
+    };
+
+    size_t capacity;
+    // Most recently used at the front
+    std::list<ShaderPermutationKey> order;
+    std::unordered_map<ShaderPermutationKey, Entry> entries;
+};
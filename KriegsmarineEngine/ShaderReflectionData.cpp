@@ -0,0 +1,269 @@
+#include "ShaderReflectionData.h"
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+    constexpr uint32_t REFLECTION_MAGIC = 0x4C464552; // "REFL"
+    constexpr uint16_t REFLECTION_VERSION = 1;
+
+    struct ReflectionHeader
+    {
+        uint32_t Magic;
+        uint16_t Version;
+        uint16_t Reserved;
+        uint64_t BlobHash;
+        uint32_t ThreadGroupSize[3];
+        uint32_t ConstantBufferCount;
+        uint32_t TextureCount;
+        uint32_t SamplerCount;
+        uint32_t UnorderedAccessViewCount;
+        uint32_t InputParameterCount;
+    };
+
+    class ByteWriter
+    {
+    public:
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            data.insert(data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void WriteString(const std::string& value)
+        {
+            Write(static_cast<uint16_t>(value.size()));
+            data.insert(data.end(), value.begin(), value.end());
+        }
+
+        std::vector<uint8_t> data;
+    };
+
+    // Every read is bounds checked; a truncated or corrupt file fails the whole parse
+    class ByteReader
+    {
+    public:
+        ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (size - offset < sizeof(T)) return false;
+
+            memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool ReadString(std::string& value)
+        {
+            uint16_t length{};
+            if (!Read(length) || size - offset < length) return false;
+
+            value.assign(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return true;
+        }
+
+        bool AtEnd() const { return offset == size; }
+
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t offset{};
+    };
+
+    void WriteBindings(ByteWriter& writer, const std::vector<ShaderReflectionBinding>& bindings)
+    {
+        for (const ShaderReflectionBinding& binding : bindings)
+        {
+            writer.Write(binding.NameHash);
+            writer.Write(binding.BindPoint);
+        }
+    }
+
+    bool ReadBindings(ByteReader& reader, uint32_t count, std::vector<ShaderReflectionBinding>& bindings)
+    {
+        bindings.resize(count);
+        for (ShaderReflectionBinding& binding : bindings)
+        {
+            if (!reader.Read(binding.NameHash) || !reader.Read(binding.BindPoint)) return false;
+        }
+        return true;
+    }
+}
+
+uint64_t HashShaderBlob(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::vector<uint8_t> WriteShaderReflection(const ShaderReflectionData& reflection)
+{
+    ReflectionHeader header{};
+    header.Magic = REFLECTION_MAGIC;
+    header.Version = REFLECTION_VERSION;
+    header.BlobHash = reflection.BlobHash;
+    for (size_t i = 0; i < reflection.ThreadGroupSize.size(); i++)
+    {
+        header.ThreadGroupSize[i] = reflection.ThreadGroupSize[i];
+    }
+    header.ConstantBufferCount = static_cast<uint32_t>(reflection.ConstantBuffers.size());
+    header.TextureCount = static_cast<uint32_t>(reflection.Textures.size());
+    header.SamplerCount = static_cast<uint32_t>(reflection.Samplers.size());
+    header.UnorderedAccessViewCount = static_cast<uint32_t>(reflection.UnorderedAccessViews.size());
+    header.InputParameterCount = static_cast<uint32_t>(reflection.InputParameters.size());
+
+    ByteWriter writer;
+    writer.Write(header);
+
+    for (const ShaderReflectionConstantBuffer& cb : reflection.ConstantBuffers)
+    {
+        writer.WriteString(cb.Name);
+        writer.Write(cb.NameHash);
+        writer.Write(cb.BindPoint);
+        writer.Write(cb.Size);
+        writer.Write(static_cast<uint32_t>(cb.Variables.size()));
+        for (const ShaderReflectionVariable& var : cb.Variables)
+        {
+            writer.Write(var.NameHash);
+            writer.Write(var.ByteOffset);
+            writer.Write(var.Size);
+        }
+    }
+
+    WriteBindings(writer, reflection.Textures);
+    WriteBindings(writer, reflection.Samplers);
+    WriteBindings(writer, reflection.UnorderedAccessViews);
+
+    for (const ShaderReflectionInputParameter& param : reflection.InputParameters)
+    {
+        writer.WriteString(param.SemanticName);
+        writer.Write(param.SemanticIndex);
+        writer.Write(param.ComponentType);
+        writer.Write(param.Mask);
+    }
+
+    return std::move(writer.data);
+}
+
+// --------------------------------------------------------
+// Parses a sidecar written by WriteShaderReflection
+//
+// blobHash - HashShaderBlob of the shader being loaded; a
+//            sidecar made from a different build is rejected
+//
+// Returns false (leaving reflection in an unspecified
+// state) if the data is stale, truncated or unrecognized
+// --------------------------------------------------------
+bool ReadShaderReflection(const uint8_t* data, size_t size, uint64_t blobHash, ShaderReflectionData& reflection)
+{
+    ByteReader reader(data, size);
+
+    ReflectionHeader header{};
+    if (!reader.Read(header) ||
+        header.Magic != REFLECTION_MAGIC ||
+        header.Version != REFLECTION_VERSION ||
+        header.BlobHash != blobHash)
+    {
+        return false;
+    }
+
+    // Every entry takes at least a few bytes, so counts beyond
+    // the file size are corrupt (and must not drive a resize)
+    uint64_t totalCount = uint64_t(header.ConstantBufferCount) + header.TextureCount + header.SamplerCount +
+        header.UnorderedAccessViewCount + header.InputParameterCount;
+    if (totalCount > size) return false;
+
+    reflection.BlobHash = header.BlobHash;
+    for (size_t i = 0; i < reflection.ThreadGroupSize.size(); i++)
+    {
+        reflection.ThreadGroupSize[i] = header.ThreadGroupSize[i];
+    }
+
+    reflection.ConstantBuffers.resize(header.ConstantBufferCount);
+    for (ShaderReflectionConstantBuffer& cb : reflection.ConstantBuffers)
+    {
+        uint32_t variableCount{};
+        if (!reader.ReadString(cb.Name) ||
+            !reader.Read(cb.NameHash) ||
+            !reader.Read(cb.BindPoint) ||
+            !reader.Read(cb.Size) ||
+            !reader.Read(variableCount) ||
+            variableCount > size)
+        {
+            return false;
+        }
+
+        cb.Variables.resize(variableCount);
+        for (ShaderReflectionVariable& var : cb.Variables)
+        {
+            if (!reader.Read(var.NameHash) || !reader.Read(var.ByteOffset) || !reader.Read(var.Size)) return false;
+        }
+    }
+
+    if (!ReadBindings(reader, header.TextureCount, reflection.Textures) ||
+        !ReadBindings(reader, header.SamplerCount, reflection.Samplers) ||
+        !ReadBindings(reader, header.UnorderedAccessViewCount, reflection.UnorderedAccessViews))
+    {
+        return false;
+    }
+
+    reflection.InputParameters.resize(header.InputParameterCount);
+    for (ShaderReflectionInputParameter& param : reflection.InputParameters)
+    {
+        if (!reader.ReadString(param.SemanticName) ||
+            !reader.Read(param.SemanticIndex) ||
+            !reader.Read(param.ComponentType) ||
+            !reader.Read(param.Mask))
+        {
+            return false;
+        }
+    }
+
+    return reader.AtEnd();
+}
+
+std::filesystem::path GetShaderReflectionPath(const std::filesystem::path& shaderFile)
+{
+    std::filesystem::path path = shaderFile;
+    path += ".refl";
+    return path;
+}
+
+bool SaveShaderReflection(const std::filesystem::path& path, const ShaderReflectionData& reflection)
+{
+    std::vector<uint8_t> data = WriteShaderReflection(reflection);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return file.good();
+}
+
+bool LoadShaderReflection(const std::filesystem::path& path, uint64_t blobHash, ShaderReflectionData& reflection)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) return false;
+
+    return ReadShaderReflection(data.data(), data.size(), blobHash, reflection);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------
+// Everything ShaderResource and its subclasses need from
+// shader reflection, free of D3D types. Filled by D3DReflect
+// once, then written next to the compiled shader so later
+// loads skip reflection entirely.
+// Names are kept as HashShaderName hashes, except the ones
+// D3D needs as strings (buffer names, semantics).
+// --------------------------------------------------------
+struct ShaderReflectionVariable
+{
+    uint32_t NameHash{};
+    uint32_t ByteOffset{};
+    uint32_t Size{};
+};
+
+struct ShaderReflectionConstantBuffer
+{
+    std::string Name{};
+    uint32_t NameHash{};
+    uint32_t BindPoint{};
+    uint32_t Size{};
+    std::vector<ShaderReflectionVariable> Variables;
+};
+
+struct ShaderReflectionBinding
+{
+    uint32_t NameHash{};
+    uint32_t BindPoint{};
+};
+
+struct ShaderReflectionInputParameter
+{
+    std::string SemanticName{};
+    uint32_t SemanticIndex{};
+    uint32_t ComponentType{}; // D3D_REGISTER_COMPONENT_TYPE
+    uint8_t Mask{};
+};
+
+struct ShaderReflectionData
+{
+    // Hash of the compiled shader the data was taken from
+    uint64_t BlobHash{};
+    std::vector<ShaderReflectionConstantBuffer> ConstantBuffers;
+    std::vector<ShaderReflectionBinding> Textures;
+    std::vector<ShaderReflectionBinding> Samplers;
+    std::vector<ShaderReflectionBinding> UnorderedAccessViews;
+    std::vector<ShaderReflectionInputParameter> InputParameters;
+    std::array<uint32_t, 3> ThreadGroupSize{};
+};
+
+// FNV-1a over the compiled shader bytes
+uint64_t HashShaderBlob(const void* data, size_t size);
+
+// Binary sidecar format. The header carries a magic, a format
+// version and the blob hash; anything that doesn't match is
+// rejected so the caller reflects again.
+std::vector<uint8_t> WriteShaderReflection(const ShaderReflectionData& reflection);
+bool ReadShaderReflection(const uint8_t* data, size_t size, uint64_t blobHash, ShaderReflectionData& reflection);
+
+// "shader.cso" -> "shader.cso.refl"
+std::filesystem::path GetShaderReflectionPath(const std::filesystem::path& shaderFile);
+bool SaveShaderReflection(const std::filesystem::path& path, const ShaderReflectionData& reflection);
+bool LoadShaderReflection(const std::filesystem::path& path, uint64_t blobHash, ShaderReflectionData& reflection);
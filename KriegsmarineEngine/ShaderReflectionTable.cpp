@@ -0,0 +1,200 @@
+#include "ShaderReflectionTable.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    // Entry of a section before it is flattened: name hash plus fields
+    template <size_t FieldCount>
+    struct Entry
+    {
+        uint32_t NameHash;
+        std::array<uint32_t, FieldCount> Fields;
+    };
+
+    // Sorts by name hash and drops repeated names, keeping the first
+    // (the same rule the old hash maps had on emplace). Names within
+    // a section are unique in HLSL, so a repeated hash is a collision
+    // that would hide one of the names; debug builds stop on it.
+    template <size_t FieldCount>
+    void SortUnique(std::vector<Entry<FieldCount>>& entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.NameHash < b.NameHash; });
+        assert(std::adjacent_find(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.NameHash == b.NameHash; }) == entries.end()
+            && "two shader names share a HashShaderName hash");
+        entries.erase(std::unique(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.NameHash == b.NameHash; }), entries.end());
+    }
+
+    // Writes the hash array and then each field array of a section
+    // from word 'next' on, recording where each array starts in the
+    // header. Returns the word after the section.
+    template <size_t FieldCount>
+    uint32_t WriteSection(uint32_t* words, uint32_t next, uint32_t hashArray, const std::vector<Entry<FieldCount>>& entries)
+    {
+        uint32_t count = static_cast<uint32_t>(entries.size());
+
+        words[hashArray] = next;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            words[next + i] = entries[i].NameHash;
+        }
+        next += count;
+
+        for (uint32_t f = 0; f < FieldCount; f++)
+        {
+            words[hashArray + 1 + f] = next;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                words[next + i] = entries[i].Fields[f];
+            }
+            next += count;
+        }
+        return next;
+    }
+}
+
+ShaderReflectionTable::ShaderReflectionTable(const ShaderReflectionData& reflection)
+{
+    std::vector<Entry<3>> constantBuffers;
+    for (uint32_t b = 0; b < reflection.ConstantBuffers.size(); b++)
+    {
+        const ShaderReflectionConstantBuffer& cb = reflection.ConstantBuffers[b];
+        constantBuffers.push_back({ cb.NameHash, { cb.BindPoint, cb.Size, b } });
+    }
+    SortUnique(constantBuffers);
+
+    // Variables refer to their buffer by its sorted index
+    std::vector<uint32_t> sortedIndex(reflection.ConstantBuffers.size(), NOT_FOUND);
+    for (uint32_t i = 0; i < constantBuffers.size(); i++)
+    {
+        sortedIndex[constantBuffers[i].Fields[2]] = i;
+    }
+
+    std::vector<Entry<3>> variables;
+    for (uint32_t b = 0; b < reflection.ConstantBuffers.size(); b++)
+    {
+        if (sortedIndex[b] == NOT_FOUND) continue;
+
+        for (const ShaderReflectionVariable& var : reflection.ConstantBuffers[b].Variables)
+        {
+            variables.push_back({ var.NameHash, { var.ByteOffset, var.Size, sortedIndex[b] } });
+        }
+    }
+    SortUnique(variables);
+
+    std::vector<Entry<1>> textures;
+    for (const ShaderReflectionBinding& texture : reflection.Textures)
+    {
+        textures.push_back({ texture.NameHash, { texture.BindPoint } });
+    }
+    SortUnique(textures);
+
+    std::vector<Entry<1>> samplers;
+    for (const ShaderReflectionBinding& sampler : reflection.Samplers)
+    {
+        samplers.push_back({ sampler.NameHash, { sampler.BindPoint } });
+    }
+    SortUnique(samplers);
+
+    // Header, then (1 + field count) arrays per section
+    wordCount = (ARRAY_COUNT + 1) +
+        constantBuffers.size() * 4 + variables.size() * 4 + textures.size() * 2 + samplers.size() * 2;
+    words = std::make_unique<uint32_t[]>(wordCount);
+
+    uint32_t next = ARRAY_COUNT + 1;
+    next = WriteSection(words.get(), next, CONSTANT_BUFFER_HASH, constantBuffers);
+    next = WriteSection(words.get(), next, VARIABLE_HASH, variables);
+    next = WriteSection(words.get(), next, TEXTURE_HASH, textures);
+    next = WriteSection(words.get(), next, SAMPLER_HASH, samplers);
+    words[ARRAY_COUNT] = next;
+}
+
+ShaderReflectionTable::ShaderReflectionTable(const ShaderReflectionTable& other)
+{
+    *this = other;
+}
+
+ShaderReflectionTable& ShaderReflectionTable::operator=(const ShaderReflectionTable& other)
+{
+    if (this == &other) return *this;
+
+    wordCount = other.wordCount;
+    words = wordCount ? std::make_unique_for_overwrite<uint32_t[]>(wordCount) : nullptr;
+    if (wordCount)
+    {
+        memcpy(words.get(), other.words.get(), wordCount * sizeof(uint32_t));
+    }
+    return *this;
+}
+
+uint32_t ShaderReflectionTable::Find(Array hashArray, uint32_t nameHash) const
+{
+    if (wordCount == 0) return NOT_FOUND;
+
+    const uint32_t* begin = words.get() + words[hashArray];
+    const uint32_t* end = words.get() + words[hashArray + 1];
+    const uint32_t* result = std::lower_bound(begin, end, nameHash);
+    if (result == end || *result != nameHash) return NOT_FOUND;
+
+    return static_cast<uint32_t>(result - begin);
+}
+
+// --------------------------------------------------------
+// Tables are kept weakly, so a layout is shared while any
+// shader uses it and forgotten after the last one is gone.
+// Expired entries are swept from the whole map whenever it
+// has doubled since the last sweep, so permutation churn and
+// reloads can't grow it past twice the live tables.
+// --------------------------------------------------------
+std::shared_ptr<const ShaderReflectionTable> ShaderReflectionTable::Intern(ShaderReflectionTable table)
+{
+    static std::mutex mutex;
+    static std::unordered_multimap<uint64_t, std::weak_ptr<const ShaderReflectionTable>> tables;
+    static size_t sweepAt = 64;
+
+    std::span<const uint32_t> words = table.GetWords();
+    uint64_t hash = HashShaderBlob(words.data(), words.size_bytes());
+
+    std::lock_guard lock(mutex);
+    auto [first, last] = tables.equal_range(hash);
+    for (auto it = first; it != last;)
+    {
+        std::shared_ptr<const ShaderReflectionTable> existing = it->second.lock();
+        if (!existing)
+        {
+            it = tables.erase(it);
+            continue;
+        }
+
+        std::span<const uint32_t> existingWords = existing->GetWords();
+        if (existingWords.size() == words.size() &&
+            memcmp(existingWords.data(), words.data(), words.size_bytes()) == 0)
+        {
+            return existing;
+        }
+        ++it;
+    }
+
+    if (tables.size() >= sweepAt)
+    {
+        std::erase_if(tables, [](const auto& entry) { return entry.second.expired(); });
+        sweepAt = std::max<size_t>(64, tables.size() * 2);
+    }
+
+    auto shared = std::make_shared<const ShaderReflectionTable>(std::move(table));
+    tables.emplace(hash, shared);
+    return shared;
+}
+
+const std::shared_ptr<const ShaderReflectionTable>& ShaderReflectionTable::GetEmpty()
+{
+    static const std::shared_ptr<const ShaderReflectionTable> empty = std::make_shared<const ShaderReflectionTable>();
+    return empty;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "ShaderReflectionData.h"
+#include <memory>
+#include <span>
+
+// --------------------------------------------------------
+// Lookup tables for a shader's reflection, flattened into a
+// single block of 32 bit words:
+//
+//   header    starting word of each field array, then the
+//             end of the last one (counts are differences)
+//   sections  constant buffers, variables, textures, samplers;
+//             each one sorted name hashes followed by parallel
+//             arrays of the entry's fields
+//
+// Lookups are binary searches over the hash array, and
+// copying a table is one allocation and a memcpy.
+// An entry's index is its position in the sorted section;
+// variables refer to their constant buffer by that index.
+// --------------------------------------------------------
+class ShaderReflectionTable
+{
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+public:
+    ShaderReflectionTable() = default;
+    explicit ShaderReflectionTable(const ShaderReflectionData& reflection);
+
+    ShaderReflectionTable(const ShaderReflectionTable& other);
+    ShaderReflectionTable& operator=(const ShaderReflectionTable& other);
+    ShaderReflectionTable(ShaderReflectionTable&&) noexcept = default;
+    ShaderReflectionTable& operator=(ShaderReflectionTable&&) noexcept = default;
+
+    // Index of the entry with the given HashShaderName, or NOT_FOUND
+    uint32_t FindConstantBuffer(uint32_t nameHash) const { return Find(CONSTANT_BUFFER_HASH, nameHash); }
+    uint32_t FindVariable(uint32_t nameHash) const { return Find(VARIABLE_HASH, nameHash); }
+    uint32_t FindTexture(uint32_t nameHash) const { return Find(TEXTURE_HASH, nameHash); }
+    uint32_t FindSampler(uint32_t nameHash) const { return Find(SAMPLER_HASH, nameHash); }
+
+    uint32_t GetConstantBufferCount() const { return Count(CONSTANT_BUFFER_HASH); }
+    uint32_t GetVariableCount() const { return Count(VARIABLE_HASH); }
+    uint32_t GetTextureCount() const { return Count(TEXTURE_HASH); }
+    uint32_t GetSamplerCount() const { return Count(SAMPLER_HASH); }
+
+    uint32_t GetConstantBufferBindPoint(uint32_t index) const { return Field(CONSTANT_BUFFER_BIND_POINT, index); }
+    uint32_t GetConstantBufferSize(uint32_t index) const { return Field(CONSTANT_BUFFER_SIZE, index); }
+    // Index into ShaderReflectionData::ConstantBuffers, for the name
+    uint32_t GetConstantBufferSource(uint32_t index) const { return Field(CONSTANT_BUFFER_SOURCE, index); }
+
+    uint32_t GetVariableOffset(uint32_t index) const { return Field(VARIABLE_OFFSET, index); }
+    uint32_t GetVariableSize(uint32_t index) const { return Field(VARIABLE_SIZE, index); }
+    uint32_t GetVariableConstantBuffer(uint32_t index) const { return Field(VARIABLE_CONSTANT_BUFFER, index); }
+
+    uint32_t GetTextureBindPoint(uint32_t index) const { return Field(TEXTURE_BIND_POINT, index); }
+    uint32_t GetSamplerBindPoint(uint32_t index) const { return Field(SAMPLER_BIND_POINT, index); }
+
+    std::span<const uint32_t> GetWords() const { return { words.get(), wordCount }; }
+    bool IsEmpty() const { return wordCount == 0; }
+
+    // Returns the shared instance of an identical table if one is
+    // alive (e.g. another permutation of the same shader), or
+    // makes this one the shared instance
+    static std::shared_ptr<const ShaderReflectionTable> Intern(ShaderReflectionTable table);
+    static const std::shared_ptr<const ShaderReflectionTable>& GetEmpty();
+
+    // fn(fromIndex, toIndex) for each variable the two tables both
+    // have, with the same name and size (e.g. across a reload)
+    template <typename Fn>
+    static void ForEachMatchingVariable(const ShaderReflectionTable& from, const ShaderReflectionTable& to, Fn&& fn)
+    {
+        uint32_t fromCount = from.GetVariableCount();
+        uint32_t toCount = to.GetVariableCount();
+
+        // Both hash arrays are sorted, so one merge pass finds every match
+        uint32_t f = 0;
+        uint32_t t = 0;
+        while (f < fromCount && t < toCount)
+        {
+            uint32_t fromHash = from.Field(VARIABLE_HASH, f);
+            uint32_t toHash = to.Field(VARIABLE_HASH, t);
+            if (fromHash < toHash)
+            {
+                ++f;
+            }
+            else if (toHash < fromHash)
+            {
+                ++t;
+            }
+            else
+            {
+                if (from.GetVariableSize(f) == to.GetVariableSize(t)) fn(f, t);
+                ++f;
+                ++t;
+            }
+        }
+    }
+
+private:
+    // One array per field, in block order; the header holds each
+    // array's starting word, then one past the last array's end
+    enum Array : uint32_t
+    {
+        CONSTANT_BUFFER_HASH,
+        CONSTANT_BUFFER_BIND_POINT,
+        CONSTANT_BUFFER_SIZE,
+        CONSTANT_BUFFER_SOURCE,
+        VARIABLE_HASH,
+        VARIABLE_OFFSET,
+        VARIABLE_SIZE,
+        VARIABLE_CONSTANT_BUFFER,
+        TEXTURE_HASH,
+        TEXTURE_BIND_POINT,
+        SAMPLER_HASH,
+        SAMPLER_BIND_POINT,
+        ARRAY_COUNT,
+    };
+
+    // Arrays of a section share their count; ask the hash array
+    uint32_t Count(Array hashArray) const
+    {
+        return wordCount ? words[hashArray + 1] - words[hashArray] : 0;
+    }
+
+    uint32_t Field(Array array, uint32_t index) const { return words[words[array] + index]; }
+
+    uint32_t Find(Array hashArray, uint32_t nameHash) const;
+
+private:
+    std::unique_ptr<uint32_t[]> words;
+    size_t wordCount{};
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+// --------------------------------------------------------
+// Decides when each watched shader reloads, free of D3D and
+// of the file watcher so a test can drive it:
+//
+//   - a changed file reloads the shaders built from it, and
+//     a changed include (.hlsli, .fxh, .h) every shader that
+//     is compiled from source in the same directory
+//   - a reload starts once its files have been quiet for the
+//     settle time, as editors may save in several writes
+//   - a shader reloads once at a time; a change that comes in
+//     during a reload waits for Finish, then reloads again
+//
+// Target is whatever the caller keeps for each shader.
+// --------------------------------------------------------
+template <typename Target>
+class ShaderReloadSchedule
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        // Absolute and normalized, to compare with FileWatcher paths
+        std::filesystem::path file;
+        // Read as it is, so includes don't affect it
+        bool compiled{};
+        Target target{};
+
+        bool changed{};
+        Clock::time_point due{};
+        bool running{};
+    };
+
+public:
+    explicit ShaderReloadSchedule(std::chrono::milliseconds settleTime) : settleTime(settleTime) {}
+
+    Entry& Add(std::filesystem::path file, bool compiled, Target target)
+    {
+        Entry& entry = entries.emplace_back();
+        entry.file = std::move(file);
+        entry.compiled = compiled;
+        entry.target = std::move(target);
+        return entry;
+    }
+
+    // Drops the entries pred(Entry&) returns true for
+    template <typename Pred>
+    void RemoveIf(Pred&& pred)
+    {
+        std::erase_if(entries, pred);
+    }
+
+    void MarkChanged(const std::filesystem::path& changedFile, Clock::time_point now)
+    {
+        bool include = IsIncludeFile(changedFile);
+        for (Entry& entry : entries)
+        {
+            bool affected = entry.file == changedFile ||
+                (include && !entry.compiled && entry.file.parent_path() == changedFile.parent_path());
+            if (affected)
+            {
+                entry.changed = true;
+                entry.due = now + settleTime;
+            }
+        }
+    }
+
+    // fn(Entry&) for each entry whose reload is due at now;
+    // the entry counts as running from then until Finish
+    template <typename Fn>
+    void StartDue(Clock::time_point now, Fn&& fn)
+    {
+        for (Entry& entry : entries)
+        {
+            if (entry.running || !entry.changed || now < entry.due) continue;
+
+            entry.changed = false;
+            entry.running = true;
+            fn(entry);
+        }
+    }
+
+    // The reload ended, whether it worked or not
+    void Finish(Entry& entry) { entry.running = false; }
+
+    std::vector<Entry>& GetEntries() { return entries; }
+
+    static bool IsIncludeFile(const std::filesystem::path& path)
+    {
+        std::filesystem::path extension = path.extension();
+        return extension == ".hlsli" || extension == ".fxh" || extension == ".h";
+    }
+
+private:
+    std::chrono::milliseconds settleTime;
+    std::vector<Entry> entries;
+};
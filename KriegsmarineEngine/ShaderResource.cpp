@@ -1,6 +1,19 @@
 #include "ShaderResource.h"
 #include "Core.Memory.h"
+#include "MemoryBudget.h"
 #include <DirectXMath.h>
+#include <atomic>
+#include <typeinfo>
+
+namespace
+{
+    // shared by every shader so a handle resolved on one shader never matches another
+    std::atomic<uint32> s_nextGeneration{ 1 };
+
+    // shader last set on each stage, so a constant buffer that moves in
+    // the ring is only re-bound when it is actually in use
+    std::array<const ShaderResource*, static_cast<size_t>(SHADER_TYPE::COUNT)> s_currentShaders{};
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // ------ BASE SIMPLE SHADER --------------------------------------------------
@@ -12,8 +25,10 @@ ShaderResource::ShaderResource(ID3D11Device* device, ID3D11DeviceContext* device
     shaderBlob(nullptr),
     shaderValid(false),
     constantBufferCount(0),
-    constantBuffers(nullptr)
+    stateCache(&RenderStateCache::ForContext(deviceContext))
 {
+    QueryUploadSupport();
+    SetConstantBufferRing(&ConstantBufferRing::ForContext(device, deviceContext));
 }
 
 // --------------------------------------------------------
@@ -25,8 +40,10 @@ ShaderResource::ShaderResource(const std::shared_ptr<DirectX11::DeviceResources>
     shaderBlob(nullptr),
     shaderValid(false),
     constantBufferCount(0),
-    constantBuffers(nullptr)
+    stateCache(&RenderStateCache::ForContext(resources->GetD3DDeviceContext()))
 {
+    QueryUploadSupport();
+    SetConstantBufferRing(&ConstantBufferRing::ForContext(device, deviceContext));
 }
 
 // --------------------------------------------------------
@@ -36,6 +53,31 @@ ShaderResource::~ShaderResource()
 {
     // Derived class destructors will call this class's CleanUp method
     Memory::SafeDelete(shaderBlob);
+    Memory::SafeDelete(deviceContext1);
+
+    for (const ShaderResource*& current : s_currentShaders)
+    {
+        if (current == this) current = nullptr;
+    }
+}
+
+// --------------------------------------------------------
+// Checks whether the device can update part of a constant
+// buffer (D3D11.1), so uploads can skip untouched bytes
+// --------------------------------------------------------
+void ShaderResource::QueryUploadSupport()
+{
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+    if (FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) ||
+        !options.ConstantBufferPartialUpdate)
+    {
+        return;
+    }
+
+    if (FAILED(deviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&deviceContext1)))
+    {
+        deviceContext1 = nullptr;
+    }
 }
 
 // --------------------------------------------------------
@@ -48,22 +90,15 @@ void ShaderResource::CleanUp()
     for (unsigned int i = 0; i < constantBufferCount; i++)
     {
         Memory::SafeDelete(constantBuffers[i].ConstantBuffer);
-        Memory::SafeDeleteArray(constantBuffers[i].LocalDataBuffer);
+        MemoryBudgets->Deallocate(constantBuffers[i].LocalDataBuffer);
+        constantBuffers[i].LocalDataBuffer = nullptr;
     }
 
-    Memory::SafeDeleteArray(constantBuffers);
+    constantBuffers.reset();
     constantBufferCount = 0;
 
-    {
-        DeferredDeleter deleter(&shaderResourceViews);
-        DeferredDeleter deleter2(&samplerStates);
-    }
-
     // Clean up tables
-    varTable.clear();
-    cbTable.clear();
-    samplerTable.clear();
-    textureTable.clear();
+    reflectionTable = ShaderReflectionTable::GetEmpty();
 }
 
 // --------------------------------------------------------
@@ -78,82 +113,278 @@ void ShaderResource::CleanUp()
 bool ShaderResource::LoadShaderFile(file::path shaderFile)
 {
     // Load the shader to a blob and ensure it worked
-    HRESULT hr = D3DReadFileToBlob(shaderFile.c_str(), &shaderBlob);
+    ID3DBlob* blob{};
+    HRESULT hr = D3DReadFileToBlob(shaderFile.c_str(), &blob);
     if (hr != S_OK)
     {
         return false;
     }
 
+    return LoadShaderBlob(blob, GetShaderReflectionPath(shaderFile));
+}
+
+// --------------------------------------------------------
+// Gets the reflection data for a compiled shader, from the
+// sidecar file when it was made from this exact blob, or
+// from D3DReflect (rewriting the sidecar for next time).
+// Touches no device or shader state, so it can run on any
+// thread.
+//
+// blob - The shader's compiled code
+// reflectionFile - The sidecar, or empty to always reflect
+// reflection - Receives the data
+// --------------------------------------------------------
+bool ShaderResource::LoadReflection(ID3DBlob* blob, const file::path& reflectionFile, ShaderReflectionData& reflection)
+{
+    uint64 blobHash = HashShaderBlob(blob->GetBufferPointer(), blob->GetBufferSize());
+    if (!reflectionFile.empty() && LoadShaderReflection(reflectionFile, blobHash, reflection))
+    {
+        return true;
+    }
+
+    reflection = {};
+    if (!ReflectShader(blob, reflection))
+    {
+        return false;
+    }
+    reflection.BlobHash = blobHash;
+
+    // Best effort, the shader directory may be read-only
+    if (!reflectionFile.empty())
+    {
+        SaveShaderReflection(reflectionFile, reflection);
+    }
+    return true;
+}
+
+// --------------------------------------------------------
+// Creates the shader and builds its tables from compiled
+// code. Takes ownership of the blob either way.
+//
+// blob - The shader's compiled code
+// reflectionFile - Reflection sidecar for the blob, optional
+//
+// Returns true if shader is loaded properly, false otherwise
+// --------------------------------------------------------
+bool ShaderResource::LoadShaderBlob(ID3DBlob* blob, const file::path& reflectionFile)
+{
+    ShaderReflectionData reflectionData;
+    if (!LoadReflection(blob, reflectionFile, reflectionData))
+    {
+        Memory::SafeDelete(blob);
+        return false;
+    }
+
+    return LoadShaderBlob(blob, std::move(reflectionData));
+}
+
+// --------------------------------------------------------
+// Creates the shader and builds its tables from compiled
+// code and its reflection. Only the device is used, so with
+// a free threaded device this may run on any thread, as
+// long as nothing else uses the shader meanwhile.
+// Takes ownership of the blob either way.
+// --------------------------------------------------------
+bool ShaderResource::LoadShaderBlob(ID3DBlob* blob, ShaderReflectionData&& reflectionData)
+{
+    // Replace the code of an earlier load
+    Memory::SafeDelete(shaderBlob);
+    shaderBlob = blob;
+    reflection = std::move(reflectionData);
+
     // Create the shader - Calls an overloaded version of this abstract
-    // method in the appropriate child class
+    // method in the appropriate child class, which can use the
+    // reflection data (input layout, UAVs) without reflecting again
     shaderValid = CreateShader(shaderBlob);
     if (!shaderValid)
     {
         return false;
     }
 
-    // Set up shader reflection to get information about
-    // this shader and its variables,  buffers, etc.
+    generation = s_nextGeneration.fetch_add(1, std::memory_order_relaxed);
+
+    // Build the lookup tables, then the buffers in table order
+    reflectionTable = ShaderReflectionTable::Intern(ShaderReflectionTable(reflection));
+    constantBufferCount = reflectionTable->GetConstantBufferCount();
+    constantBuffers = std::make_unique<ShaderConstantBuffer[]>(constantBufferCount);
+
+    for (unsigned int b = 0; b < constantBufferCount; b++)
+    {
+        uint32 size = reflectionTable->GetConstantBufferSize(b);
+
+        constantBuffers[b].BindIndex = reflectionTable->GetConstantBufferBindPoint(b);
+        constantBuffers[b].Name = reflection.ConstantBuffers[reflectionTable->GetConstantBufferSource(b)].Name;
+
+        // Create this constant buffer
+        D3D11_BUFFER_DESC newBuffDesc{};
+        newBuffDesc.Usage = D3D11_USAGE_DEFAULT;
+        newBuffDesc.ByteWidth = size;
+        newBuffDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        newBuffDesc.CPUAccessFlags = 0;
+        newBuffDesc.MiscFlags = 0;
+        newBuffDesc.StructureByteStride = 0;
+        device->CreateBuffer(&newBuffDesc, 0, &constantBuffers[b].ConstantBuffer);
+
+        // Set up the data buffer for this constant buffer
+        constantBuffers[b].Size = size;
+        constantBuffers[b].LocalDataBuffer = static_cast<byte*>(MemoryBudgets->Allocate(MemoryHeap::ShaderData, size));
+        ZeroMemory(constantBuffers[b].LocalDataBuffer, size);
+        constantBuffers[b].Dirty.MarkAll(size);
+    }
+
+    // Everything needed later lives in the table now
+    reflection = {};
+
+    // All set
+    return true;
+}
+
+// --------------------------------------------------------
+// Compiles a shader from HLSL source, resolving #include
+// relative to the source file
+//
+// sourceFile - The .hlsl file
+// entryPoint, profile - e.g. "main", "ps_5_0"
+// defines - Null terminated macro list, optional
+// errors - Receives the compiler output on failure, optional
+//
+// Returns the compiled code (owned by the caller), or null
+// --------------------------------------------------------
+ID3DBlob* ShaderResource::CompileShaderFile(const file::path& sourceFile, const std::string& entryPoint,
+    const std::string& profile, const D3D_SHADER_MACRO* defines, std::string* errors)
+{
+    UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#if defined(_DEBUG)
+    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+
+    ID3DBlob* blob{};
+    ID3DBlob* errorBlob{};
+    HRESULT hr = D3DCompileFromFile(sourceFile.c_str(), defines, D3D_COMPILE_STANDARD_FILE_INCLUDE,
+        entryPoint.c_str(), profile.c_str(), flags, 0, &blob, &errorBlob);
+
+    if (errors && errorBlob)
+    {
+        errors->assign(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+    }
+    Memory::SafeDelete(errorBlob);
+
+    if (hr != S_OK)
+    {
+        Memory::SafeDelete(blob);
+        return nullptr;
+    }
+    return blob;
+}
+
+// --------------------------------------------------------
+// Swaps in a freshly loaded shader (see the header). Run it
+// between frames on the thread that uses this shader.
+//
+// replacement - A loaded shader of the same class
+//
+// Returns false (changing nothing) if it isn't one
+// --------------------------------------------------------
+bool ShaderResource::ReplaceWith(ShaderResource& replacement)
+{
+    if (&replacement == this || typeid(replacement) != typeid(*this) || !replacement.shaderValid)
+    {
+        return false;
+    }
+
+    // Keep what was set so far, for every variable that survived
+    ShaderReflectionTable::ForEachMatchingVariable(*reflectionTable, *replacement.reflectionTable,
+        [&](uint32 from, uint32 to)
+        {
+            const ShaderConstantBuffer& source = constantBuffers[reflectionTable->GetVariableConstantBuffer(from)];
+            ShaderConstantBuffer& target = replacement.constantBuffers[replacement.reflectionTable->GetVariableConstantBuffer(to)];
+
+            memcpy(target.LocalDataBuffer + replacement.reflectionTable->GetVariableOffset(to),
+                source.LocalDataBuffer + reflectionTable->GetVariableOffset(from),
+                reflectionTable->GetVariableSize(from));
+        });
+
+    SwapContents(replacement);
+
+    // The new buffers were created empty
+    for (unsigned int b = 0; b < constantBufferCount; b++)
+    {
+        constantBuffers[b].Dirty.MarkAll(constantBuffers[b].Size);
+    }
+    return true;
+}
+
+void ShaderResource::SwapContents(ShaderResource& other)
+{
+    std::swap(shaderValid, other.shaderValid);
+    std::swap(shaderBlob, other.shaderBlob);
+    std::swap(constantBufferCount, other.constantBufferCount);
+    std::swap(constantBuffers, other.constantBuffers);
+    std::swap(reflectionTable, other.reflectionTable);
+    // Handles resolved before the swap must not match the new tables
+    std::swap(generation, other.generation);
+}
+
+// --------------------------------------------------------
+// Runs D3D shader reflection over a compiled shader and
+// keeps what the shader classes need
+//
+// shaderBlob - The shader's compiled code
+// reflection - Receives buffers, resources and inputs
+//
+// Returns false if the blob could not be reflected
+// --------------------------------------------------------
+bool ShaderResource::ReflectShader(ID3DBlob* shaderBlob, ShaderReflectionData& reflection)
+{
     ID3D11ShaderReflection* refl{};
-    D3DReflect(
+    HRESULT hr = D3DReflect(
         shaderBlob->GetBufferPointer(),
         shaderBlob->GetBufferSize(),
         IID_ID3D11ShaderReflection,
         (void**)&refl);
+    if (FAILED(hr))
+    {
+        return false;
+    }
 
     // Get the description of the shader
     D3D11_SHADER_DESC shaderDesc;
     refl->GetDesc(&shaderDesc);
 
-    // Create resource arrays
-    constantBufferCount = shaderDesc.ConstantBuffers;
-    constantBuffers = new ShaderConstantBuffer[constantBufferCount];
-
-    // Handle bound resources (like shaders and samplers)
-    unsigned int resourceCount = shaderDesc.BoundResources;
-    for (unsigned int r = 0; r < resourceCount; r++)
+    // Handle bound resources (like shaders, samplers and UAVs)
+    for (unsigned int r = 0; r < shaderDesc.BoundResources; r++)
     {
-        // Get this resource's description
         D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
         refl->GetResourceBindingDesc(r, &resourceDesc);
 
-        // Check the type
+        ShaderReflectionBinding binding{ HashShaderName(resourceDesc.Name), resourceDesc.BindPoint };
         switch (resourceDesc.Type)
         {
-        case D3D_SIT_TEXTURE: // A texture resource
-        {
-            // Create the SRV wrapper
-            ShaderResourceViewIndex* srv = new ShaderResourceViewIndex();
-            srv->BindIndex = resourceDesc.BindPoint;	// Shader bind point
-            srv->Index = static_cast<uint32>(shaderResourceViews.size());	// Raw index
-
-            textureTable.insert(std::pair<std::string, ShaderResourceViewIndex*>(resourceDesc.Name, srv));
-            shaderResourceViews.push_back(srv);
-        }
-        break;
-
-        case D3D_SIT_SAMPLER: // A sampler resource
-        {
-            // Create the sampler wrapper
-            ShaderSampler* samp = new ShaderSampler();
-            samp->BindIndex = resourceDesc.BindPoint;	// Shader bind point
-            samp->Index = static_cast<uint32>(samplerStates.size());			// Raw index
-
-            samplerTable.insert(std::pair<std::string, ShaderSampler*>(resourceDesc.Name, samp));
-            samplerStates.push_back(samp);
-        }
-        break;
+        case D3D_SIT_TEXTURE:
+            reflection.Textures.push_back(binding);
+            break;
+
+        case D3D_SIT_SAMPLER:
+            reflection.Samplers.push_back(binding);
+            break;
+
+        case D3D_SIT_UAV_APPEND_STRUCTURED:
+        case D3D_SIT_UAV_CONSUME_STRUCTURED:
+        case D3D_SIT_UAV_RWBYTEADDRESS:
+        case D3D_SIT_UAV_RWSTRUCTURED:
+        case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
+        case D3D_SIT_UAV_RWTYPED:
+            reflection.UnorderedAccessViews.push_back(binding);
+            break;
         }
     }
 
-    // Loop through all constant buffers
-    for (unsigned int b = 0; b < constantBufferCount; b++)
+    // Constant buffers and their variables
+    reflection.ConstantBuffers.resize(shaderDesc.ConstantBuffers);
+    for (unsigned int b = 0; b < shaderDesc.ConstantBuffers; b++)
     {
-        // Get this buffer
-        ID3D11ShaderReflectionConstantBuffer* cb =
-            refl->GetConstantBufferByIndex(b);
+        ID3D11ShaderReflectionConstantBuffer* cb = refl->GetConstantBufferByIndex(b);
 
-        // Get the description of this buffer
         D3D11_SHADER_BUFFER_DESC bufferDesc;
         cb->GetDesc(&bufferDesc);
 
@@ -162,101 +393,221 @@ bool ShaderResource::LoadShaderFile(file::path shaderFile)
         D3D11_SHADER_INPUT_BIND_DESC bindDesc;
         refl->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
 
-        // Set up the buffer and put its pointer in the table
-        constantBuffers[b].BindIndex = bindDesc.BindPoint;
-        constantBuffers[b].Name = bufferDesc.Name;
-        cbTable.insert(std::pair<std::string, ShaderConstantBuffer*>(bufferDesc.Name, &constantBuffers[b]));
-
-        // Create this constant buffer
-        D3D11_BUFFER_DESC newBuffDesc{};
-        newBuffDesc.Usage = D3D11_USAGE_DEFAULT;
-        newBuffDesc.ByteWidth = bufferDesc.Size;
-        newBuffDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        newBuffDesc.CPUAccessFlags = 0;
-        newBuffDesc.MiscFlags = 0;
-        newBuffDesc.StructureByteStride = 0;
-        device->CreateBuffer(&newBuffDesc, 0, &constantBuffers[b].ConstantBuffer);
-
-        // Set up the data buffer for this constant buffer
-        constantBuffers[b].Size = bufferDesc.Size;
-        constantBuffers[b].LocalDataBuffer = new byte[bufferDesc.Size];
-        ZeroMemory(constantBuffers[b].LocalDataBuffer, bufferDesc.Size);
+        ShaderReflectionConstantBuffer& buffer = reflection.ConstantBuffers[b];
+        buffer.Name = bufferDesc.Name;
+        buffer.NameHash = HashShaderName(bufferDesc.Name);
+        buffer.BindPoint = bindDesc.BindPoint;
+        buffer.Size = bufferDesc.Size;
 
-        // Loop through all variables in this buffer
+        buffer.Variables.resize(bufferDesc.Variables);
         for (unsigned int v = 0; v < bufferDesc.Variables; v++)
         {
-            // Get this variable
-            ID3D11ShaderReflectionVariable* var = cb->GetVariableByIndex(v);
-            ID3D11ShaderReflectionType* varType = var->GetType();
-
             D3D11_SHADER_VARIABLE_DESC varDesc;
+            cb->GetVariableByIndex(v)->GetDesc(&varDesc);
 
-            // Get the description of the variable and its type
-            var->GetDesc(&varDesc);
-
-            // Create the variable struct
-            ConstantBufferVariable varStruct{};
-            varStruct.ConstantBufferIndex = b;
-            varStruct.ByteOffset = varDesc.StartOffset;
-            varStruct.Size = varDesc.Size;
-
-            // Get a string version
-            std::string varName(varDesc.Name);
-
-            // Add this variable to the table and the constant buffer
-            varTable.insert(std::pair<std::string, ConstantBufferVariable>(varName, varStruct));
-            constantBuffers[b].Variables.push_back(varStruct);
+            buffer.Variables[v] = { HashShaderName(varDesc.Name), varDesc.StartOffset, varDesc.Size };
         }
     }
 
-    // All set
+    // Vertex inputs, for building an input layout
+    reflection.InputParameters.resize(shaderDesc.InputParameters);
+    for (unsigned int i = 0; i < shaderDesc.InputParameters; i++)
+    {
+        D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
+        refl->GetInputParameterDesc(i, &paramDesc);
+
+        ShaderReflectionInputParameter& param = reflection.InputParameters[i];
+        param.SemanticName = paramDesc.SemanticName;
+        param.SemanticIndex = paramDesc.SemanticIndex;
+        param.ComponentType = paramDesc.ComponentType;
+        param.Mask = paramDesc.Mask;
+    }
+
+    // Compute thread group size (zero for other stages)
+    refl->GetThreadGroupSize(
+        &reflection.ThreadGroupSize[0],
+        &reflection.ThreadGroupSize[1],
+        &reflection.ThreadGroupSize[2]);
+
     refl->Release();
     return true;
 }
 
 // --------------------------------------------------------
-// Helper for looking up a variable by name and also
-// verifying that it is the requested size
+// Helper for looking up a variable by name
 // 
-// name - the name of the variable to look for
-// size - the size of the variable (for verification), or -1 to bypass
+// nameHash - HashShaderName of the variable to look for
+//
+// Returns the variable's table index, or NOT_FOUND
 // --------------------------------------------------------
-ConstantBufferVariable* ShaderResource::FindVariable(std::string name, int size)
+uint32 ShaderResource::FindVariable(uint32 nameHash) const
 {
-    // Look for the key
-    std::unordered_map<std::string, ConstantBufferVariable>::iterator result =
-        varTable.find(name);
+    return reflectionTable->FindVariable(nameHash);
+}
 
-    // Did we find the key?
-    if (result == varTable.end())
+// --------------------------------------------------------
+// Helper for looking up a constant buffer by name
+// --------------------------------------------------------
+ShaderConstantBuffer* ShaderResource::FindConstantBuffer(uint32 nameHash)
+{
+    uint32 index = reflectionTable->FindConstantBuffer(nameHash);
+    if (index == ShaderReflectionTable::NOT_FOUND)
         return 0;
 
-    // Grab the result from the iterator
-    ConstantBufferVariable* var = &(result->second);
+    return &constantBuffers[index];
+}
 
-    // Is the data size correct ?
-    if (size > 0 && var->Size != size)
-        return 0;
+// --------------------------------------------------------
+// Turns a handle into its variable. A handle from the
+// current load is used as is (no lock, no hashing - reloads
+// only happen between frames); anything else is looked up
+// by its name hash.
+//
+// size - the size of the data being set, must match
+// --------------------------------------------------------
+uint32 ShaderResource::ResolveVariable(const ShaderVariableHandle& handle, size_t size) const
+{
+    uint32 var = ShaderReflectionTable::NOT_FOUND;
+    if (handle.Generation == generation && handle.Index < reflectionTable->GetVariableCount())
+    {
+        var = handle.Index;
+    }
+    else
+    {
+        var = FindVariable(handle.NameHash);
+    }
+
+    if (var == ShaderReflectionTable::NOT_FOUND || reflectionTable->GetVariableSize(var) != size)
+        return ShaderReflectionTable::NOT_FOUND;
 
-    // Success
     return var;
 }
 
 // --------------------------------------------------------
-// Helper for looking up a constant buffer by name
+// Resolves a variable name once for use with SetData(handle)
 // --------------------------------------------------------
-ShaderConstantBuffer* ShaderResource::FindConstantBuffer(std::string name)
+ShaderVariableHandle ShaderResource::GetVariableHandle(std::string_view name) const
 {
-    // Look for the key
-    std::unordered_map<std::string, ShaderConstantBuffer*>::iterator result =
-        cbTable.find(name);
+    ShaderVariableHandle handle{ HashShaderName(name) };
+    uint32 index = reflectionTable->FindVariable(handle.NameHash);
+    if (index != ShaderReflectionTable::NOT_FOUND)
+    {
+        handle.Index = index;
+        handle.Generation = generation;
+    }
+    return handle;
+}
 
-    // Did we find the key?
-    if (result == cbTable.end())
-        return 0;
+// --------------------------------------------------------
+// Resolves a texture name once for use with
+// SetShaderResourceView(handle)
+// --------------------------------------------------------
+ShaderBindingHandle ShaderResource::GetShaderResourceViewHandle(std::string_view name) const
+{
+    ShaderBindingHandle handle{ HashShaderName(name) };
+    uint32 index = reflectionTable->FindTexture(handle.NameHash);
+    if (index != ShaderReflectionTable::NOT_FOUND)
+    {
+        handle.BindIndex = reflectionTable->GetTextureBindPoint(index);
+        handle.Generation = generation;
+    }
+    return handle;
+}
+
+// --------------------------------------------------------
+// Resolves a sampler name once for use with
+// SetSamplerState(handle)
+// --------------------------------------------------------
+ShaderBindingHandle ShaderResource::GetSamplerHandle(std::string_view name) const
+{
+    ShaderBindingHandle handle{ HashShaderName(name) };
+    uint32 index = reflectionTable->FindSampler(handle.NameHash);
+    if (index != ShaderReflectionTable::NOT_FOUND)
+    {
+        handle.BindIndex = reflectionTable->GetSamplerBindPoint(index);
+        handle.Generation = generation;
+    }
+    return handle;
+}
+
+// --------------------------------------------------------
+// Sets a shader resource view in this shader's stage
+//
+// handle - From GetShaderResourceViewHandle, or a bare name hash
+// srv - The shader resource view of the texture in GPU memory
+//
+// Returns true if a texture of the given name was found, false otherwise
+// --------------------------------------------------------
+bool ShaderResource::SetShaderResourceView(const ShaderBindingHandle& handle, ID3D11ShaderResourceView* srv)
+{
+    uint32 bindIndex = UINT32_MAX;
+    if (handle.Generation == generation)
+    {
+        bindIndex = handle.BindIndex;
+    }
+    else
+    {
+        uint32 index = reflectionTable->FindTexture(handle.NameHash);
+        if (index != ShaderReflectionTable::NOT_FOUND)
+            bindIndex = reflectionTable->GetTextureBindPoint(index);
+    }
+
+    if (bindIndex == UINT32_MAX)
+        return false;
+
+    stateCache->SetShaderResource(GetShaderType(), bindIndex, srv);
+    stateCache->Commit(GetShaderType());
+    return true;
+}
+
+bool ShaderResource::SetShaderResourceView(ShaderName name, ID3D11ShaderResourceView* srv)
+{
+    return SetShaderResourceView(ShaderBindingHandle{ name.Hash }, srv);
+}
+
+bool ShaderResource::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
+{
+    return SetShaderResourceView(ShaderBindingHandle{ HashShaderName(name) }, srv);
+}
+
+// --------------------------------------------------------
+// Sets a sampler state in this shader's stage
+//
+// handle - From GetSamplerHandle, or a bare name hash
+// samplerState - The sampler state in GPU memory
+//
+// Returns true if a sampler of the given name was found, false otherwise
+// --------------------------------------------------------
+bool ShaderResource::SetSamplerState(const ShaderBindingHandle& handle, ID3D11SamplerState* samplerState)
+{
+    uint32 bindIndex = UINT32_MAX;
+    if (handle.Generation == generation)
+    {
+        bindIndex = handle.BindIndex;
+    }
+    else
+    {
+        uint32 index = reflectionTable->FindSampler(handle.NameHash);
+        if (index != ShaderReflectionTable::NOT_FOUND)
+            bindIndex = reflectionTable->GetSamplerBindPoint(index);
+    }
+
+    if (bindIndex == UINT32_MAX)
+        return false;
+
+    stateCache->SetSampler(GetShaderType(), bindIndex, samplerState);
+    stateCache->Commit(GetShaderType());
+    return true;
+}
 
-    // Success
-    return result->second;
+bool ShaderResource::SetSamplerState(ShaderName name, ID3D11SamplerState* samplerState)
+{
+    return SetSamplerState(ShaderBindingHandle{ name.Hash }, samplerState);
+}
+
+bool ShaderResource::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
+{
+    return SetSamplerState(ShaderBindingHandle{ HashShaderName(name) }, samplerState);
 }
 
 // --------------------------------------------------------
@@ -267,29 +618,166 @@ void ShaderResource::SetShader()
     // Ensure the shader is valid
     if (!shaderValid) return;
 
+    // Ring ranges from earlier frames are about to be reclaimed,
+    // bring them into the current frame before binding them
+    if (constantBufferRing)
+    {
+        for (unsigned int i = 0; i < constantBufferCount; i++)
+        {
+            const ConstantBufferRing::Allocation& allocation = constantBuffers[i].RingAllocation;
+            if (allocation.IsValid() && allocation.Frame != constantBufferRing->GetFrame())
+            {
+                UploadConstantBuffer(constantBuffers[i]);
+            }
+        }
+    }
+
+    s_currentShaders[static_cast<size_t>(GetShaderType())] = this;
+
     // Set the shader and any relevant constant buffers, which
     // is an overloaded method in a subclass
     SetShaderAndCBs();
 }
 
+// --------------------------------------------------------
+// Switches constant data between a shared ring and this
+// shader's own constant buffers
+//
+// ring - The ring to upload to, or nullptr
+// --------------------------------------------------------
+void ShaderResource::SetConstantBufferRing(ConstantBufferRing* ring)
+{
+    if (ring && !ring->IsSupported()) ring = nullptr;
+    if (ring == constantBufferRing) return;
+
+    constantBufferRing = ring;
+    for (unsigned int i = 0; i < constantBufferCount; i++)
+    {
+        // The own buffers missed everything written to a ring
+        if (constantBuffers[i].RingAllocation.IsValid())
+        {
+            constantBuffers[i].RingAllocation = {};
+            constantBuffers[i].Dirty.MarkAll(constantBuffers[i].Size);
+        }
+    }
+}
+
+bool ShaderResource::IsCurrentShader() const
+{
+    return s_currentShaders[static_cast<size_t>(GetShaderType())] == this;
+}
+
 // --------------------------------------------------------
 // Copies the relevant data to the all of this 
 // shader's constant buffers.  To just copy one
 // buffer, use CopyBufferData()
+//
+// Buffers nothing was written to since the last copy are
+// skipped entirely
 // --------------------------------------------------------
 void ShaderResource::CopyAllBufferData()
 {
     // Ensure the shader is valid
     if (!shaderValid) return;
 
-    // Loop through the constant buffers and copy all data
+    // Loop through the constant buffers and copy dirty data
     for (unsigned int i = 0; i < constantBufferCount; i++)
     {
-        // Copy the entire local data buffer
-        deviceContext->UpdateSubresource(
-            constantBuffers[i].ConstantBuffer, 0, 0,
-            constantBuffers[i].LocalDataBuffer, 0, 0);
+        if (UploadConstantBuffer(constantBuffers[i]) && IsCurrentShader())
+        {
+            BindConstantBuffer(constantBuffers[i]);
+        }
     }
+    stateCache->Commit(GetShaderType());
+}
+
+// --------------------------------------------------------
+// Stages a constant buffer in the state cache, as a range
+// of the ring when its data was last written there
+// --------------------------------------------------------
+void ShaderResource::BindConstantBuffer(const ShaderConstantBuffer& cb)
+{
+    RenderStateCache::ConstantBufferBinding binding{ cb.ConstantBuffer };
+    if (cb.RingAllocation.IsValid())
+    {
+        binding = { cb.RingAllocation.Buffer, cb.RingAllocation.FirstConstant, cb.RingAllocation.NumConstants };
+    }
+    stateCache->SetConstantBuffer(GetShaderType(), cb.BindIndex, binding);
+}
+
+// --------------------------------------------------------
+// Binds all constant buffers in one go, so the state cache
+// can drop unchanged ones and merge contiguous slots
+// --------------------------------------------------------
+void ShaderResource::BindConstantBuffers()
+{
+    for (unsigned int i = 0; i < constantBufferCount; i++)
+    {
+        BindConstantBuffer(constantBuffers[i]);
+    }
+    stateCache->Commit(GetShaderType());
+}
+
+// --------------------------------------------------------
+// Writes a constant buffer's data to the ring, when one is
+// in use, or the dirty part of it to the buffer's own copy.
+// A ring range is only valid for the frame it was written
+// in; clean data from an earlier frame is written again.
+// --------------------------------------------------------
+bool ShaderResource::UploadConstantBuffer(ShaderConstantBuffer& cb)
+{
+    if (!constantBufferRing)
+    {
+        UploadToOwnBuffer(cb);
+        return false;
+    }
+
+    ConstantBufferUploadStats& stats = ConstantBufferUploadStats::GetGlobal();
+    if (!cb.Dirty.IsDirty() && cb.RingAllocation.IsValid() && cb.RingAllocation.Frame == constantBufferRing->GetFrame())
+    {
+        stats.RecordSkip();
+        return false;
+    }
+
+    ConstantBufferRing::Allocation allocation = constantBufferRing->Upload(cb.LocalDataBuffer, cb.Size);
+    if (allocation.IsValid())
+    {
+        cb.RingAllocation = allocation;
+        cb.Dirty.Clear();
+        stats.RecordUpload(cb.Size);
+        return true;
+    }
+
+    // The ring is full, fall back to the buffer's own copy
+    bool wasInRing = cb.RingAllocation.IsValid();
+    if (wasInRing)
+    {
+        cb.RingAllocation = {};
+        cb.Dirty.MarkAll(cb.Size);
+    }
+    UploadToOwnBuffer(cb);
+    return wasInRing;
+}
+
+// --------------------------------------------------------
+// Copies the dirty range of a local data buffer to its
+// constant buffer - just the range on D3D11.1, the whole
+// buffer otherwise (D3D11.0 can't partially update them)
+// --------------------------------------------------------
+void ShaderResource::UploadToOwnBuffer(ShaderConstantBuffer& cb)
+{
+    UploadIfDirty(cb, deviceContext1 != nullptr, [&](uint32 offset, uint32 size)
+        {
+            if (deviceContext1)
+            {
+                D3D11_BOX box{ offset, 0, 0, offset + size, 1, 1 };
+                deviceContext1->UpdateSubresource1(cb.ConstantBuffer, 0, &box, cb.LocalDataBuffer + offset, 0, 0, 0);
+            }
+            else
+            {
+                deviceContext->UpdateSubresource(cb.ConstantBuffer, 0, 0, cb.LocalDataBuffer, 0, 0);
+            }
+        });
 }
 
 // --------------------------------------------------------
@@ -317,9 +805,11 @@ void ShaderResource::CopyBufferData(unsigned int index)
     if (!cb) return;
 
     // Copy the data and get out
-    deviceContext->UpdateSubresource(
-        cb->ConstantBuffer, 0, 0,
-        cb->LocalDataBuffer, 0, 0);
+    if (UploadConstantBuffer(*cb) && IsCurrentShader())
+    {
+        BindConstantBuffer(*cb);
+        stateCache->Commit(GetShaderType());
+    }
 }
 
 // --------------------------------------------------------
@@ -329,95 +819,92 @@ void ShaderResource::CopyBufferData(unsigned int index)
 //              Useful for updating more frequently-changing
 //              variables without having to re-copy all buffers.
 // --------------------------------------------------------
-void ShaderResource::CopyBufferData(std::string bufferName)
+void ShaderResource::CopyBufferData(std::string_view bufferName)
 {
     // Ensure the shader is valid
     if (!shaderValid) return;
 
     // Check for the buffer
-    ShaderConstantBuffer* cb = this->FindConstantBuffer(bufferName);
+    ShaderConstantBuffer* cb = this->FindConstantBuffer(HashShaderName(bufferName));
     if (!cb) return;
 
     // Copy the data and get out
-    deviceContext->UpdateSubresource(
-        cb->ConstantBuffer, 0, 0,
-        cb->LocalDataBuffer, 0, 0);
+    if (UploadConstantBuffer(*cb) && IsCurrentShader())
+    {
+        BindConstantBuffer(*cb);
+        stateCache->Commit(GetShaderType());
+    }
 }
 
 // --------------------------------------------------------
 // Gets info about a shader variable, if it exists
 // --------------------------------------------------------
-const ConstantBufferVariable* ShaderResource::GetVariableInfo(std::string name)
+std::optional<ConstantBufferVariable> ShaderResource::GetVariableInfo(std::string_view name)
 {
-    return FindVariable(name, -1);
+    uint32 index = FindVariable(HashShaderName(name));
+    if (index == ShaderReflectionTable::NOT_FOUND)
+        return std::nullopt;
+
+    return ConstantBufferVariable{
+        reflectionTable->GetVariableOffset(index),
+        reflectionTable->GetVariableSize(index),
+        reflectionTable->GetVariableConstantBuffer(index) };
 }
 
 // --------------------------------------------------------
-// Gets info about an SRV in the shader (or null)
+// Gets info about an SRV in the shader (or nothing)
 //
 // name - the name of the SRV
 // --------------------------------------------------------
-const ShaderResourceViewIndex* ShaderResource::GetShaderResourceViewInfo(std::string name)
+std::optional<ShaderResourceViewIndex> ShaderResource::GetShaderResourceViewInfo(std::string_view name)
 {
-    // Look for the key
-    std::unordered_map<std::string, ShaderResourceViewIndex*>::iterator result =
-        textureTable.find(name);
+    uint32 index = reflectionTable->FindTexture(HashShaderName(name));
+    if (index == ShaderReflectionTable::NOT_FOUND)
+        return std::nullopt;
 
-    // Did we find the key?
-    if (result == textureTable.end())
-        return 0;
-
-    // Success
-    return result->second;
+    return ShaderResourceViewIndex{ index, reflectionTable->GetTextureBindPoint(index) };
 }
 
 
 // --------------------------------------------------------
-// Gets info about an SRV in the shader (or null)
+// Gets info about an SRV in the shader (or nothing)
 //
 // index - the index of the SRV
 // --------------------------------------------------------
-const ShaderResourceViewIndex* ShaderResource::GetShaderResourceViewInfo(unsigned int index)
+std::optional<ShaderResourceViewIndex> ShaderResource::GetShaderResourceViewInfo(unsigned int index)
 {
     // Valid index?
-    if (index >= shaderResourceViews.size()) return 0;
+    if (index >= reflectionTable->GetTextureCount()) return std::nullopt;
 
-    // Grab the bind index
-    return shaderResourceViews[index];
+    return ShaderResourceViewIndex{ index, reflectionTable->GetTextureBindPoint(index) };
 }
 
 
 // --------------------------------------------------------
-// Gets info about a sampler in the shader (or null)
+// Gets info about a sampler in the shader (or nothing)
 // 
 // name - the name of the sampler
 // --------------------------------------------------------
-const ShaderSampler* ShaderResource::GetSamplerInfo(std::string name)
+std::optional<ShaderSampler> ShaderResource::GetSamplerInfo(std::string_view name)
 {
-    // Look for the key
-    std::unordered_map<std::string, ShaderSampler*>::iterator result =
-        samplerTable.find(name);
-
-    // Did we find the key?
-    if (result == samplerTable.end())
-        return 0;
+    uint32 index = reflectionTable->FindSampler(HashShaderName(name));
+    if (index == ShaderReflectionTable::NOT_FOUND)
+        return std::nullopt;
 
-    // Success
-    return result->second;
+    return ShaderSampler{ index, reflectionTable->GetSamplerBindPoint(index) };
 }
 
 // --------------------------------------------------------
-// Gets info about a sampler in the shader (or null)
+// Gets info about a sampler in the shader (or nothing)
 // 
 // index - the index of the sampler
 // --------------------------------------------------------
-const ShaderSampler* ShaderResource::GetSamplerInfo(unsigned int index)
+std::optional<ShaderSampler> ShaderResource::GetSamplerInfo(unsigned int index)
 {
     // Valid index?
-    if (index >= samplerStates.size()) return 0;
+    if (index >= reflectionTable->GetSamplerCount()) return std::nullopt;
 
-    // Grab the bind index
-    return samplerStates[index];
+    return ShaderSampler{ index, reflectionTable->GetSamplerBindPoint(index) };
 }
 
 // --------------------------------------------------------
@@ -443,9 +930,9 @@ unsigned int ShaderResource::GetBufferSize(unsigned int index)
 // Gets info about a particular constant buffer 
 // by name, if it exists
 // --------------------------------------------------------
-const ShaderConstantBuffer* ShaderResource::GetBufferInfo(std::string name)
+const ShaderConstantBuffer* ShaderResource::GetBufferInfo(std::string_view name)
 {
-    return FindConstantBuffer(name);
+    return FindConstantBuffer(HashShaderName(name));
 }
 
 // --------------------------------------------------------
@@ -1,8 +1,16 @@
 #pragma once
 #include "SimpleShaderDefine.h"
+#include "RenderStateCache.h"
+#include "ShaderReflectionTable.h"
 #include "DeviceResources.h"
+#include <optional>
 // --------------------------------------------------------
 // Base abstract class for simplifying shader handling
+//
+// Not locked: a shader is used from one thread, and loads,
+// reloads (ReplaceWith) and cleanup of a shader in use only
+// happen between frames on that thread. Loader threads only
+// touch shaders nobody else can see yet.
 // --------------------------------------------------------
 class ShaderResource abstract
 {
@@ -14,6 +22,24 @@ public:
     // Initialization method (since we can't invoke derived class
     // overrides in the base class constructor)
     bool LoadShaderFile(file::path shaderFile);
+    // Same, from compiled code already in memory; takes ownership of
+    // the blob. The reflection sidecar is used if a path is given.
+    bool LoadShaderBlob(ID3DBlob* blob, const file::path& reflectionFile = {});
+    // Same, with reflection already done by LoadReflection (e.g. on a loader thread)
+    bool LoadShaderBlob(ID3DBlob* blob, ShaderReflectionData&& reflectionData);
+
+    // Sidecar or D3DReflect, whichever is current; needs no device
+    static bool LoadReflection(ID3DBlob* blob, const file::path& reflectionFile, ShaderReflectionData& reflection);
+    // Compiles HLSL source; null on failure, with the compiler output in errors
+    static ID3DBlob* CompileShaderFile(const file::path& sourceFile, const std::string& entryPoint,
+        const std::string& profile, const D3D_SHADER_MACRO* defines = nullptr, std::string* errors = nullptr);
+
+    // Takes over the code, buffers and tables of a freshly loaded
+    // shader of the same class (hot reload), carrying over the
+    // values of variables both have. Pointers to this shader and
+    // its handles stay valid; GetBufferInfo pointers do not.
+    // The replacement is left with the old contents.
+    bool ReplaceWith(ShaderResource& replacement);
 
     // Simple helpers
     bool IsShaderValid() const { return shaderValid; }
@@ -22,66 +48,118 @@ public:
     void SetShader();
     void CopyAllBufferData();
     void CopyBufferData(unsigned int index);
-    void CopyBufferData(std::string bufferName);
+    void CopyBufferData(std::string_view bufferName);
 
+    // Constant data goes to a shared per-frame ring instead of this
+    // shader's own buffers; the context's ConstantBufferRing::ForContext
+    // ring when the device supports it, from construction on. The ring
+    // must outlive the shader; pass nullptr to go back to the shader's
+    // own buffers.
+    void SetConstantBufferRing(ConstantBufferRing* ring);
+
+    // Resolve once, then set per draw without any name lookup
+    ShaderVariableHandle GetVariableHandle(std::string_view name) const;
+    ShaderBindingHandle GetShaderResourceViewHandle(std::string_view name) const;
+    ShaderBindingHandle GetSamplerHandle(std::string_view name) const;
+
+    template<typename T>
+    bool SetData(const ShaderVariableHandle& handle, const T& data);
+    template<typename T>
+    bool SetData(ShaderName name, const T& data);
     template<typename T>
-    bool SetData(std::string name, const T& data);
+    bool SetData(std::string_view name, const T& data);
 
     template<typename T, size_t N>
-    bool SetData(std::string name, const T data[N]);
+    bool SetData(std::string_view name, const T (&data)[N]);
 
     // Setting shader resources
-    virtual bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv) = 0;
-    virtual bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState) = 0;
+    bool SetShaderResourceView(const ShaderBindingHandle& handle, ID3D11ShaderResourceView* srv);
+    bool SetShaderResourceView(ShaderName name, ID3D11ShaderResourceView* srv);
+    bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+    bool SetSamplerState(const ShaderBindingHandle& handle, ID3D11SamplerState* samplerState);
+    bool SetSamplerState(ShaderName name, ID3D11SamplerState* samplerState);
+    bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
 
     // Getting data about variables and resources
-    const ConstantBufferVariable* GetVariableInfo(std::string name);
+    std::optional<ConstantBufferVariable> GetVariableInfo(std::string_view name);
 
-    const ShaderResourceViewIndex* GetShaderResourceViewInfo(std::string name);
-    const ShaderResourceViewIndex* GetShaderResourceViewInfo(unsigned int index);
-    unsigned int GetShaderResourceViewCount() { return static_cast<unsigned int>(textureTable.size()); }
+    std::optional<ShaderResourceViewIndex> GetShaderResourceViewInfo(std::string_view name);
+    std::optional<ShaderResourceViewIndex> GetShaderResourceViewInfo(unsigned int index);
+    unsigned int GetShaderResourceViewCount() { return reflectionTable->GetTextureCount(); }
 
-    const ShaderSampler* GetSamplerInfo(std::string name);
-    const ShaderSampler* GetSamplerInfo(unsigned int index);
-    unsigned int GetSamplerCount() { return static_cast<unsigned int>(samplerTable.size()); }
+    std::optional<ShaderSampler> GetSamplerInfo(std::string_view name);
+    std::optional<ShaderSampler> GetSamplerInfo(unsigned int index);
+    unsigned int GetSamplerCount() { return reflectionTable->GetSamplerCount(); }
 
     // Get data about constant buffers
     unsigned int GetBufferCount() const;
     unsigned int GetBufferSize(unsigned int index);
-    const ShaderConstantBuffer* GetBufferInfo(std::string name);
+    const ShaderConstantBuffer* GetBufferInfo(std::string_view name);
     const ShaderConstantBuffer* GetBufferInfo(unsigned int index);
 
     // Misc getters
     ID3DBlob* GetShaderBlob() { return shaderBlob; }
+    // Shared between shaders (e.g. permutations) with identical layouts
+    const std::shared_ptr<const ShaderReflectionTable>& GetReflectionTable() const { return reflectionTable; }
 
 protected:
     // Pure virtual functions for dealing with shader types
     virtual bool CreateShader(ID3DBlob* shaderBlob) = 0;
     virtual void SetShaderAndCBs() = 0;
+    virtual SHADER_TYPE GetShaderType() const = 0;
 
     virtual void CleanUp();
-
-    // Helpers for finding data by name
-    ConstantBufferVariable* FindVariable(std::string name, int size);
-    ShaderConstantBuffer* FindConstantBuffer(std::string name);
+    // Exchanges everything a load creates; subclasses add their own objects
+    virtual void SwapContents(ShaderResource& other);
+
+    static bool ReflectShader(ID3DBlob* shaderBlob, ShaderReflectionData& reflection);
+
+    // Uploads the dirty part of one buffer, if any. Returns true
+    // when the buffer has to be bound again (it moved in the ring)
+    bool UploadConstantBuffer(ShaderConstantBuffer& cb);
+    void UploadToOwnBuffer(ShaderConstantBuffer& cb);
+    // Whether this is the shader last set on its stage
+    bool IsCurrentShader() const;
+
+    // Stages a constant buffer (at its ring offset, if it lives
+    // there) in the state cache; the caller commits
+    void BindConstantBuffer(const ShaderConstantBuffer& cb);
+    // Binds all of this shader's constant buffers
+    void BindConstantBuffers();
+    void QueryUploadSupport();
+
+    // Helpers for finding data by name hash; variables are
+    // reflectionTable indices (ShaderReflectionTable::NOT_FOUND)
+    uint32 FindVariable(uint32 nameHash) const;
+    ShaderConstantBuffer* FindConstantBuffer(uint32 nameHash);
+    uint32 ResolveVariable(const ShaderVariableHandle& handle, size_t size) const;
 
 protected:
     bool shaderValid;
     ID3DBlob* shaderBlob;
     ID3D11Device* device;
     ID3D11DeviceContext* deviceContext;
+    // D3D11.1 context for partial constant buffer updates, null when unsupported
+    ID3D11DeviceContext1* deviceContext1{};
+    ConstantBufferRing* constantBufferRing{};
+    // Shared by every shader on the same context
+    RenderStateCache* stateCache{};
 
     // Resource counts
     unsigned int constantBufferCount;
 
-    // Maps for variables and buffers
-    ShaderConstantBuffer* constantBuffers; // For index-based lookup
-    std::vector<ShaderResourceViewIndex*> shaderResourceViews;
-    std::vector<ShaderSampler*>	samplerStates;
-    std::unordered_map<std::string, ShaderConstantBuffer*> cbTable;
-    std::unordered_map<std::string, ConstantBufferVariable> varTable;
-    std::unordered_map<std::string, ShaderResourceViewIndex*> textureTable;
-    std::unordered_map<std::string, ShaderSampler*> samplerTable;
+    // In reflectionTable's constant buffer order
+    std::unique_ptr<ShaderConstantBuffer[]> constantBuffers;
+    // Every name lookup (buffers, variables, textures, samplers),
+    // keyed by HashShaderName, in one allocation; interned
+    std::shared_ptr<const ShaderReflectionTable> reflectionTable{ ShaderReflectionTable::GetEmpty() };
+
+    // For the subclasses' CreateShader, filled before it runs
+    // and released once the tables are built
+    ShaderReflectionData reflection;
+
+    // Changes on every load, so handles from before a reload re-resolve
+    uint32 generation{};
 
 };
 
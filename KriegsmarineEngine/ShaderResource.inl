@@ -1,42 +1,70 @@
 #include "ShaderResource.h"
 // --------------------------------------------------------
-// Sets a variable by name with arbitrary data of the specified size
+// Sets a variable through a resolved handle
 //
-// name - The name of the shader variable
-// data - The data to set in the buffer
-// size - The size of the data (this must match the variable's size)
+// handle - From GetVariableHandle, or a bare name hash
+// data - The data to set in the buffer (its size must match
+//        the variable's size)
 //
 // Returns true if data is copied, false if variable doesn't 
 // exist or sizes don't match
 // --------------------------------------------------------
 template <typename T>
-inline bool ShaderResource::SetData(std::string name, const T& data)
+inline bool ShaderResource::SetData(const ShaderVariableHandle& handle, const T& data)
 {
-    ConstantBufferVariable* var = FindVariable(name, sizeof(T));
-    if (var == 0)
+    uint32 var = ResolveVariable(handle, sizeof(T));
+    if (var == ShaderReflectionTable::NOT_FOUND)
     {
         return false;
     }
 
-    byte* buffer = constantBuffers[var->ConstantBufferIndex].LocalDataBuffer + var->ByteOffset;
+    ShaderConstantBuffer& cb = constantBuffers[reflectionTable->GetVariableConstantBuffer(var)];
+    uint32 offset = reflectionTable->GetVariableOffset(var);
     size_t size = sizeof(T);
 
-    memcpy(buffer, &data, size);
+    memcpy(cb.LocalDataBuffer + offset, &data, size);
+    cb.Dirty.Mark(offset, static_cast<uint32>(size));
     return true;
 }
 
+// --------------------------------------------------------
+// Sets a variable by a compile-time hashed name
+// --------------------------------------------------------
+template <typename T>
+inline bool ShaderResource::SetData(ShaderName name, const T& data)
+{
+    return SetData(ShaderVariableHandle{ name.Hash }, data);
+}
+
+// --------------------------------------------------------
+// Sets a variable by name - hashes the name on every call,
+// prefer a handle for anything set per draw
+// --------------------------------------------------------
+template <typename T>
+inline bool ShaderResource::SetData(std::string_view name, const T& data)
+{
+    return SetData(ShaderVariableHandle{ HashShaderName(name) }, data);
+}
+
+// --------------------------------------------------------
+// Sets an array variable by name; N is deduced from the
+// argument, so the whole array has to match the variable
+// --------------------------------------------------------
 template<typename T, size_t N>
-inline bool ShaderResource::SetData(std::string name, const T data[N])
+inline bool ShaderResource::SetData(std::string_view name, const T (&data)[N])
 {
-    ConstantBufferVariable* var = FindVariable(name, sizeof(T) * N);
-    if (var == 0 || var->ElementCount != N)
+    // the size check covers the element count
+    uint32 var = ResolveVariable(ShaderVariableHandle{ HashShaderName(name) }, sizeof(T) * N);
+    if (var == ShaderReflectionTable::NOT_FOUND)
     {
         return false;
     }
 
-    byte* buffer = constantBuffers[var->ConstantBufferIndex].LocalDataBuffer + var->ByteOffset;
+    ShaderConstantBuffer& cb = constantBuffers[reflectionTable->GetVariableConstantBuffer(var)];
+    uint32 offset = reflectionTable->GetVariableOffset(var);
     size_t size = sizeof(T) * N;
 
-    memcpy(buffer, &data, size);
+    memcpy(cb.LocalDataBuffer + offset, data, size);
+    cb.Dirty.Mark(offset, static_cast<uint32>(size));
     return true;
 }
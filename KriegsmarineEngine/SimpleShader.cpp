@@ -1,5 +1,7 @@
 #include "SimpleShader.h"
+#include "InputLayoutCache.h"
 #include "Core.Memory.h"
+#include "StackAllocator.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // ------ SIMPLE VERTEX SHADER ------------------------------------------------
@@ -27,8 +29,9 @@ SimpleVertexShader::SimpleVertexShader(const std::shared_ptr<DirectX11::DeviceRe
 SimpleVertexShader::SimpleVertexShader(const std::shared_ptr<DirectX11::DeviceResources>& resources, ID3D11InputLayout* inputLayout, bool perInstanceCompatible)
 	: ShaderResource(resources)
 {
-	// Save the custom input layout
+	// Save the custom input layout (the caller keeps it alive)
 	this->inputLayout = inputLayout;
+	this->customInputLayout = inputLayout != nullptr;
 	this->shader = nullptr;
 
 	// Unable to determine from an input layout, require user to tell us
@@ -50,7 +53,28 @@ void SimpleVertexShader::CleanUp()
 {
 	ShaderResource::CleanUp();
 	Memory::SafeDelete(shader);
-	Memory::SafeDelete(inputLayout);
+
+	// Only the reference from InputLayoutCache is ours; a custom
+	// layout stays for the next CreateShader
+	if (inputLayout && !customInputLayout)
+	{
+		inputLayout->Release();
+		inputLayout = nullptr;
+	}
+}
+
+// --------------------------------------------------------
+// Exchanges loaded state with another SimpleVertexShader (hot reload)
+// --------------------------------------------------------
+void SimpleVertexShader::SwapContents(ShaderResource& other)
+{
+	ShaderResource::SwapContents(other);
+
+	SimpleVertexShader& replacement = static_cast<SimpleVertexShader&>(other);
+	std::swap(shader, replacement.shader);
+	std::swap(inputLayout, replacement.inputLayout);
+	std::swap(customInputLayout, replacement.customInputLayout);
+	std::swap(perInstanceCompatible, replacement.perInstanceCompatible);
 }
 
 // --------------------------------------------------------
@@ -83,40 +107,29 @@ bool SimpleVertexShader::CreateShader(ID3DBlob* shaderBlob)
 		return true;
 
 	// Vertex shader was created successfully, so we now use the
-	// shader code to re-reflect and create an input layout that 
-	// matches what the vertex shader expects.  Code adapted from:
+	// reflected inputs to create an input layout that matches
+	// what the vertex shader expects.  Code adapted from:
 	// https://takinginitiative.wordpress.com/2011/12/11/directx-1011-basic-shader-reflection-automatic-input-layout-creation/
-
-	// Reflect shader info
-	ID3D11ShaderReflection* refl{};
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)&refl);
-
-	// Get shader info
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
+	// (LoadShaderFile reflected the shader already, or read
+	// the inputs from the sidecar file)
+	const std::vector<ShaderReflectionInputParameter>& inputs = reflection.InputParameters;
+	unsigned int inputCount = static_cast<unsigned int>(inputs.size());
 
 	// Read input layout description from shader info
-	std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayoutDesc;
-	for (unsigned int i = 0; i < shaderDesc.InputParameters; i++)
+	// (scratch memory is rewound when this function returns)
+	StackAllocatorScope scratch;
+	D3D11_INPUT_ELEMENT_DESC* inputLayoutDesc = scratch.AllocateArray<D3D11_INPUT_ELEMENT_DESC>(inputCount);
+	for (unsigned int i = 0; i < inputCount; i++)
 	{
-		D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
-		refl->GetInputParameterDesc(i, &paramDesc);
+		const ShaderReflectionInputParameter& paramDesc = inputs[i];
 
 		// Check the semantic name for "_PER_INSTANCE"
-		std::string perInstanceStr = "_PER_INSTANCE";
-		std::string sem = paramDesc.SemanticName;
-		int lenDiff = static_cast<int>(sem.size() - perInstanceStr.size());
-		bool isPerInstance =
-			lenDiff >= 0 &&
-			sem.compare(lenDiff, perInstanceStr.size(), perInstanceStr) == 0;
+		std::string_view sem = paramDesc.SemanticName;
+		bool isPerInstance = sem.ends_with("_PER_INSTANCE");
 
 		// Fill out input element desc
 		D3D11_INPUT_ELEMENT_DESC elementDesc{};
-		elementDesc.SemanticName = paramDesc.SemanticName;
+		elementDesc.SemanticName = paramDesc.SemanticName.c_str();
 		elementDesc.SemanticIndex = paramDesc.SemanticIndex;
 		elementDesc.InputSlot = 0;
 		elementDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
@@ -137,19 +150,13 @@ bool SimpleVertexShader::CreateShader(ID3DBlob* shaderBlob)
 		elementDesc.Format = DetermineFormatFromComponentType(paramDesc.Mask, paramDesc.ComponentType);
 
 		// Save element desc
-		inputLayoutDesc.push_back(elementDesc);
+		inputLayoutDesc[i] = elementDesc;
 	}
 
-	// Try to create Input Layout
-	HRESULT hr = device->CreateInputLayout(
-		&inputLayoutDesc[0],
-		static_cast<uint32>(inputLayoutDesc.size()),
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		&inputLayout);
+	// Get the Input Layout, shared with every shader that has the same inputs
+	inputLayout = InputLayoutCache::ForDevice(device).Acquire(inputLayoutDesc, inputCount, shaderBlob);
 
-	// All done, clean up
-	refl->Release();
+	// All done
 	return true;
 }
 
@@ -163,61 +170,11 @@ void SimpleVertexShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader and input layout
-	deviceContext->IASetInputLayout(inputLayout);
-	deviceContext->VSSetShader(shader, 0, 0);
+	stateCache->SetInputLayout(inputLayout);
+	stateCache->SetShader(shader);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		deviceContext->VSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			&constantBuffers[i].ConstantBuffer);
-	}
-}
-
-// --------------------------------------------------------
-// Sets a shader resource view in the vertex shader stage
-//
-// name - The name of the texture resource in the shader
-// srv - The shader resource view of the texture in GPU memory
-//
-// Returns true if a texture of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleVertexShader::SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv)
-{
-	// Look for the variable and verify
-	const ShaderResourceViewIndex* srvInfo = GetShaderResourceViewInfo(name);
-	if (srvInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->VSSetShaderResources(srvInfo->BindIndex, 1, &srv);
-
-	// Success
-	return true;
-}
-
-// --------------------------------------------------------
-// Sets a sampler state in the vertex shader stage
-//
-// name - The name of the sampler state in the shader
-// samplerState - The sampler state in GPU memory
-//
-// Returns true if a sampler of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleVertexShader::SetSamplerState(std::string name, ID3D11SamplerState* samplerState)
-{
-	// Look for the variable and verify
-	const ShaderSampler* sampInfo = GetSamplerInfo(name);
-	if (sampInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->VSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
-
-	// Success
-	return true;
+	BindConstantBuffers();
 }
 
 
@@ -251,6 +208,17 @@ void SimplePixelShader::CleanUp()
 	Memory::SafeDelete(shader);
 }
 
+// --------------------------------------------------------
+// Exchanges loaded state with another SimplePixelShader (hot reload)
+// --------------------------------------------------------
+void SimplePixelShader::SwapContents(ShaderResource& other)
+{
+	ShaderResource::SwapContents(other);
+
+	SimplePixelShader& replacement = static_cast<SimplePixelShader&>(other);
+	std::swap(shader, replacement.shader);
+}
+
 // --------------------------------------------------------
 // Creates the DirectX pixel shader
 //
@@ -285,60 +253,10 @@ void SimplePixelShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader
-	deviceContext->PSSetShader(shader, 0, 0);
+	stateCache->SetShader(shader);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		deviceContext->PSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			&constantBuffers[i].ConstantBuffer);
-	}
-}
-
-// --------------------------------------------------------
-// Sets a shader resource view in the pixel shader stage
-//
-// name - The name of the texture resource in the shader
-// srv - The shader resource view of the texture in GPU memory
-//
-// Returns true if a texture of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimplePixelShader::SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv)
-{
-	// Look for the variable and verify
-	const ShaderResourceViewIndex* srvInfo = GetShaderResourceViewInfo(name);
-	if (srvInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->PSSetShaderResources(srvInfo->BindIndex, 1, &srv);
-
-	// Success
-	return true;
-}
-
-// --------------------------------------------------------
-// Sets a sampler state in the pixel shader stage
-//
-// name - The name of the sampler state in the shader
-// samplerState - The sampler state in GPU memory
-//
-// Returns true if a sampler of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimplePixelShader::SetSamplerState(std::string name, ID3D11SamplerState* samplerState)
-{
-	// Look for the variable and verify
-	const ShaderSampler* sampInfo = GetSamplerInfo(name);
-	if (sampInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->PSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
-
-	// Success
-	return true;
+	BindConstantBuffers();
 }
 
 
@@ -374,6 +292,17 @@ void SimpleDomainShader::CleanUp()
 	Memory::SafeDelete(shader);
 }
 
+// --------------------------------------------------------
+// Exchanges loaded state with another SimpleDomainShader (hot reload)
+// --------------------------------------------------------
+void SimpleDomainShader::SwapContents(ShaderResource& other)
+{
+	ShaderResource::SwapContents(other);
+
+	SimpleDomainShader& replacement = static_cast<SimpleDomainShader&>(other);
+	std::swap(shader, replacement.shader);
+}
+
 // --------------------------------------------------------
 // Creates the DirectX domain shader
 //
@@ -408,60 +337,10 @@ void SimpleDomainShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader
-	deviceContext->DSSetShader(shader, 0, 0);
+	stateCache->SetShader(shader);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		deviceContext->DSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			&constantBuffers[i].ConstantBuffer);
-	}
-}
-
-// --------------------------------------------------------
-// Sets a shader resource view in the domain shader stage
-//
-// name - The name of the texture resource in the shader
-// srv - The shader resource view of the texture in GPU memory
-//
-// Returns true if a texture of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleDomainShader::SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv)
-{
-	// Look for the variable and verify
-	const ShaderResourceViewIndex* srvInfo = GetShaderResourceViewInfo(name);
-	if (srvInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->DSSetShaderResources(srvInfo->BindIndex, 1, &srv);
-
-	// Success
-	return true;
-}
-
-// --------------------------------------------------------
-// Sets a sampler state in the domain shader stage
-//
-// name - The name of the sampler state in the shader
-// samplerState - The sampler state in GPU memory
-//
-// Returns true if a sampler of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleDomainShader::SetSamplerState(std::string name, ID3D11SamplerState* samplerState)
-{
-	// Look for the variable and verify
-	const ShaderSampler* sampInfo = GetSamplerInfo(name);
-	if (sampInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->DSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
-
-	// Success
-	return true;
+	BindConstantBuffers();
 }
 
 
@@ -496,6 +375,17 @@ void SimpleHullShader::CleanUp()
 	Memory::SafeDelete(shader);
 }
 
+// --------------------------------------------------------
+// Exchanges loaded state with another SimpleHullShader (hot reload)
+// --------------------------------------------------------
+void SimpleHullShader::SwapContents(ShaderResource& other)
+{
+	ShaderResource::SwapContents(other);
+
+	SimpleHullShader& replacement = static_cast<SimpleHullShader&>(other);
+	std::swap(shader, replacement.shader);
+}
+
 // --------------------------------------------------------
 // Creates the DirectX hull shader
 //
@@ -530,60 +420,10 @@ void SimpleHullShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader
-	deviceContext->HSSetShader(shader, 0, 0);
-
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		deviceContext->HSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			&constantBuffers[i].ConstantBuffer);
-	}
-}
+	stateCache->SetShader(shader);
 
-// --------------------------------------------------------
-// Sets a shader resource view in the hull shader stage
-//
-// name - The name of the texture resource in the shader
-// srv - The shader resource view of the texture in GPU memory
-//
-// Returns true if a texture of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleHullShader::SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv)
-{
-	// Look for the variable and verify
-	const ShaderResourceViewIndex* srvInfo = GetShaderResourceViewInfo(name);
-	if (srvInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->HSSetShaderResources(srvInfo->BindIndex, 1, &srv);
-
-	// Success
-	return true;
-}
-
-// --------------------------------------------------------
-// Sets a sampler state in the hull shader stage
-//
-// name - The name of the sampler state in the shader
-// samplerState - The sampler state in GPU memory
-//
-// Returns true if a sampler of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleHullShader::SetSamplerState(std::string name, ID3D11SamplerState* samplerState)
-{
-	// Look for the variable and verify
-	const ShaderSampler* sampInfo = GetSamplerInfo(name);
-	if (sampInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->HSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
-
-	// Success
-	return true;
+	// Set the constant buffers
+	BindConstantBuffers();
 }
 
 
@@ -621,6 +461,18 @@ void SimpleGeometryShader::CleanUp()
 	Memory::SafeDelete(shader);
 }
 
+// --------------------------------------------------------
+// Exchanges loaded state with another SimpleGeometryShader (hot reload)
+// --------------------------------------------------------
+void SimpleGeometryShader::SwapContents(ShaderResource& other)
+{
+	ShaderResource::SwapContents(other);
+
+	SimpleGeometryShader& replacement = static_cast<SimpleGeometryShader&>(other);
+	std::swap(shader, replacement.shader);
+	std::swap(streamOutVertexSize, replacement.streamOutVertexSize);
+}
+
 // --------------------------------------------------------
 // Creates the DirectX Geometry shader
 //
@@ -677,7 +529,8 @@ bool SimpleGeometryShader::CreateShaderWithStreamOut(ID3DBlob* shaderBlob)
 
 	// Set up the output signature
 	streamOutVertexSize = 0;
-	std::vector<D3D11_SO_DECLARATION_ENTRY> soDecl;
+	StackAllocatorScope scratch;
+	D3D11_SO_DECLARATION_ENTRY* soDecl = scratch.AllocateArray<D3D11_SO_DECLARATION_ENTRY>(shaderDesc.OutputParameters);
 	for (unsigned int i = 0; i < shaderDesc.OutputParameters; i++)
 	{
 		// Get the info about this entry
@@ -699,7 +552,7 @@ bool SimpleGeometryShader::CreateShaderWithStreamOut(ID3DBlob* shaderBlob)
 		streamOutVertexSize += entry.ComponentCount * sizeof(float);
 
 		// Add to the declaration
-		soDecl.push_back(entry);
+		soDecl[i] = entry;
 	}
 
 	// Rasterization allowed?
@@ -709,8 +562,8 @@ bool SimpleGeometryShader::CreateShaderWithStreamOut(ID3DBlob* shaderBlob)
 	HRESULT result = device->CreateGeometryShaderWithStreamOutput(
 		shaderBlob->GetBufferPointer(), // Shader blob pointer
 		shaderBlob->GetBufferSize(),    // Shader blob size
-		&soDecl[0],                     // Stream out declaration
-		static_cast<uint32>(soDecl.size()),                  // Number of declaration entries
+		soDecl,                         // Stream out declaration
+		shaderDesc.OutputParameters,    // Number of declaration entries
 		NULL,                           // Buffer strides (not used - assume tightly packed?)
 		0,                              // No buffer strides
 		rast,                           // Index of the stream to rasterize (if any)
@@ -774,60 +627,10 @@ void SimpleGeometryShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader
-	deviceContext->GSSetShader(shader, 0, 0);
-
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		deviceContext->GSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			&constantBuffers[i].ConstantBuffer);
-	}
-}
-
-// --------------------------------------------------------
-// Sets a shader resource view in the Geometry shader stage
-//
-// name - The name of the texture resource in the shader
-// srv - The shader resource view of the texture in GPU memory
-//
-// Returns true if a texture of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleGeometryShader::SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv)
-{
-	// Look for the variable and verify
-	const ShaderResourceViewIndex* srvInfo = GetShaderResourceViewInfo(name);
-	if (srvInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->GSSetShaderResources(srvInfo->BindIndex, 1, &srv);
-
-	// Success
-	return true;
-}
-
-// --------------------------------------------------------
-// Sets a sampler state in the Geometry shader stage
-//
-// name - The name of the sampler state in the shader
-// samplerState - The sampler state in GPU memory
-//
-// Returns true if a sampler of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleGeometryShader::SetSamplerState(std::string name, ID3D11SamplerState* samplerState)
-{
-	// Look for the variable and verify
-	const ShaderSampler* sampInfo = GetSamplerInfo(name);
-	if (sampInfo == nullptr)
-		return false;
+	stateCache->SetShader(shader);
 
-	// Set the shader resource view
-	deviceContext->GSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
-
-	// Success
-	return true;
+	// Set the constant buffers
+	BindConstantBuffers();
 }
 
 // --------------------------------------------------------
@@ -880,6 +683,22 @@ void SimpleComputeShader::CleanUp()
 	uavTable.clear();
 }
 
+// --------------------------------------------------------
+// Exchanges loaded state with another SimpleComputeShader (hot reload)
+// --------------------------------------------------------
+void SimpleComputeShader::SwapContents(ShaderResource& other)
+{
+	ShaderResource::SwapContents(other);
+
+	SimpleComputeShader& replacement = static_cast<SimpleComputeShader&>(other);
+	std::swap(shader, replacement.shader);
+	std::swap(uavTable, replacement.uavTable);
+	std::swap(threadsX, replacement.threadsX);
+	std::swap(threadsY, replacement.threadsY);
+	std::swap(threadsZ, replacement.threadsZ);
+	std::swap(threadsTotal, replacement.threadsTotal);
+}
+
 // --------------------------------------------------------
 // Creates the DirectX Compute shader
 //
@@ -904,47 +723,19 @@ bool SimpleComputeShader::CreateShader(ID3DBlob* shaderBlob)
 	if (result != S_OK)
 		return false;
 
-	// Set up shader reflection to get information about UAV's
-	ID3D11ShaderReflection* refl{};
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)&refl);
+	// Grab the thread info from the reflection LoadShaderFile did
+	threadsX = reflection.ThreadGroupSize[0];
+	threadsY = reflection.ThreadGroupSize[1];
+	threadsZ = reflection.ThreadGroupSize[2];
+	threadsTotal = threadsX * threadsY * threadsZ;
 
-	// Get the description of the shader
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
-
-	// Grab the thread info
-	threadsTotal = refl->GetThreadGroupSize(
-		&threadsX,
-		&threadsY,
-		&threadsZ);
-
-	// Loop and get all UAV resources
-	unsigned int resourceCount = shaderDesc.BoundResources;
-	for (unsigned int r = 0; r < resourceCount; r++)
+	// Get all UAV resources
+	for (const ShaderReflectionBinding& uav : reflection.UnorderedAccessViews)
 	{
-		// Get this resource's description
-		D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
-		refl->GetResourceBindingDesc(r, &resourceDesc);
-
-		// Check the type, looking for any kind of UAV
-		switch (resourceDesc.Type)
-		{
-		case D3D_SIT_UAV_APPEND_STRUCTURED:
-		case D3D_SIT_UAV_CONSUME_STRUCTURED:
-		case D3D_SIT_UAV_RWBYTEADDRESS:
-		case D3D_SIT_UAV_RWSTRUCTURED:
-		case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
-		case D3D_SIT_UAV_RWTYPED:
-			uavTable.insert(std::pair<std::string, unsigned int>(resourceDesc.Name, resourceDesc.BindPoint));
-		}
+		uavTable.emplace(uav.NameHash, uav.BindPoint);
 	}
 
 	// All set
-	refl->Release();
 	return true;
 }
 
@@ -958,16 +749,10 @@ void SimpleComputeShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader
-	deviceContext->CSSetShader(shader, 0, 0);
+	stateCache->SetShader(shader);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		deviceContext->CSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			&constantBuffers[i].ConstantBuffer);
-	}
+	// Set the constant buffers
+	BindConstantBuffers();
 }
 
 // --------------------------------------------------------
@@ -1023,50 +808,6 @@ void SimpleComputeShader::DispatchByThreads(unsigned int threadsX, unsigned int
 		max((unsigned int)ceil((float)threadsZ / this->threadsZ), 1));
 }
 
-// --------------------------------------------------------
-// Sets a shader resource view in the Compute shader stage
-//
-// name - The name of the texture resource in the shader
-// srv - The shader resource view of the texture in GPU memory
-//
-// Returns true if a texture of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleComputeShader::SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv)
-{
-	// Look for the variable and verify
-	const ShaderResourceViewIndex* srvInfo = GetShaderResourceViewInfo(name);
-	if (srvInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->CSSetShaderResources(srvInfo->BindIndex, 1, &srv);
-
-	// Success
-	return true;
-}
-
-// --------------------------------------------------------
-// Sets a sampler state in the Compute shader stage
-//
-// name - The name of the sampler state in the shader
-// samplerState - The sampler state in GPU memory
-//
-// Returns true if a sampler of the given name was found, false otherwise
-// --------------------------------------------------------
-bool SimpleComputeShader::SetSamplerState(std::string name, ID3D11SamplerState* samplerState)
-{
-	// Look for the variable and verify
-	const ShaderSampler* sampInfo = GetSamplerInfo(name);
-	if (sampInfo == nullptr)
-		return false;
-
-	// Set the shader resource view
-	deviceContext->CSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
-
-	// Success
-	return true;
-}
-
 // --------------------------------------------------------
 // Sets an unordered access view in the Compute shader stage
 //
@@ -1076,15 +817,15 @@ bool SimpleComputeShader::SetSamplerState(std::string name, ID3D11SamplerState*
 //
 // Returns true if a UAV of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetUnorderedAccessView(std::string name, ID3D11UnorderedAccessView* uav, unsigned int appendConsumeOffset)
+bool SimpleComputeShader::SetUnorderedAccessView(std::string_view name, ID3D11UnorderedAccessView* uav, unsigned int appendConsumeOffset)
 {
 	// Look for the variable and verify
 	unsigned int bindIndex = GetUnorderedAccessViewIndex(name);
 	if (bindIndex == -1)
 		return false;
 
-	// Set the shader resource view
-	deviceContext->CSSetUnorderedAccessViews(bindIndex, 1, &uav, &appendConsumeOffset);
+	// Set the unordered access view
+	stateCache->SetUnorderedAccessView(bindIndex, uav, appendConsumeOffset);
 
 	// Success
 	return true;
@@ -1093,11 +834,10 @@ bool SimpleComputeShader::SetUnorderedAccessView(std::string name, ID3D11Unorder
 // --------------------------------------------------------
 // Gets the index of the specified UAV (or -1)
 // --------------------------------------------------------
-int SimpleComputeShader::GetUnorderedAccessViewIndex(std::string name)
+int SimpleComputeShader::GetUnorderedAccessViewIndex(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, unsigned int>::iterator result =
-		uavTable.find(name);
+	auto result = uavTable.find(HashShaderName(name));
 
 	// Did we find the key?
 	if (result == uavTable.end())
@@ -14,17 +14,19 @@ public:
 	ID3D11InputLayout* GetInputLayout() { return inputLayout; }
 	bool GetPerInstanceCompatible() const { return perInstanceCompatible; }
 
-	bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv);
-	bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState);
 
 protected:
+	SHADER_TYPE GetShaderType() const { return SHADER_TYPE::VERTEX_SHADER; }
 	bool CreateShader(ID3DBlob* shaderBlob);
 	void SetShaderAndCBs();
 	void CleanUp();
+	void SwapContents(ShaderResource& other);
 
 protected:
 	bool perInstanceCompatible{};
 	ID3D11InputLayout* inputLayout{};
+	// Passed to the constructor and not owned, as opposed to acquired from InputLayoutCache
+	bool customInputLayout{};
 	ID3D11VertexShader* shader{};
 };
 
@@ -39,13 +41,13 @@ public:
 	~SimplePixelShader();
 	ID3D11PixelShader* GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv);
-	bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState);
 
 protected:
+	SHADER_TYPE GetShaderType() const { return SHADER_TYPE::PIXEL_SHADER; }
 	bool CreateShader(ID3DBlob* shaderBlob);
 	void SetShaderAndCBs();
 	void CleanUp();
+	void SwapContents(ShaderResource& other);
 
 protected:
 	ID3D11PixelShader* shader{};
@@ -61,13 +63,13 @@ public:
 	~SimpleDomainShader();
 	ID3D11DomainShader* GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv);
-	bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState);
 
 protected:
+	SHADER_TYPE GetShaderType() const { return SHADER_TYPE::DOMAIN_SHADER; }
 	bool CreateShader(ID3DBlob* shaderBlob);
 	void SetShaderAndCBs();
 	void CleanUp();
+	void SwapContents(ShaderResource& other);
 
 protected:
 	ID3D11DomainShader* shader{};
@@ -84,13 +86,13 @@ public:
 	~SimpleHullShader();
 	ID3D11HullShader* GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv);
-	bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState);
 
 protected:
+	SHADER_TYPE GetShaderType() const { return SHADER_TYPE::HULL_SHADER; }
 	bool CreateShader(ID3DBlob* shaderBlob);
 	void SetShaderAndCBs();
 	void CleanUp();
+	void SwapContents(ShaderResource& other);
 
 protected:
 	ID3D11HullShader* shader{};
@@ -107,18 +109,18 @@ public:
 	~SimpleGeometryShader();
 	ID3D11GeometryShader* GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv);
-	bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState);
 
 	bool CreateCompatibleStreamOutBuffer(ID3D11Buffer** buffer, int vertexCount);
 
 	static void UnbindStreamOutStage(ID3D11DeviceContext* deviceContext);
 
 protected:
+	SHADER_TYPE GetShaderType() const { return SHADER_TYPE::GEOMETRY_SHADER; }
 	bool CreateShader(ID3DBlob* shaderBlob);
 	bool CreateShaderWithStreamOut(ID3DBlob* shaderBlob);
 	void SetShaderAndCBs();
 	void CleanUp();
+	void SwapContents(ShaderResource& other);
 
 	// Helpers
 	unsigned int CalcComponentCount(unsigned int mask);
@@ -147,20 +149,20 @@ public:
 	void DispatchByGroups(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
 	void DispatchByThreads(unsigned int threadsX, unsigned int threadsY, unsigned int threadsZ);
 
-	bool SetShaderResourceView(std::string name, ID3D11ShaderResourceView* srv);
-	bool SetSamplerState(std::string name, ID3D11SamplerState* samplerState);
-	bool SetUnorderedAccessView(std::string name, ID3D11UnorderedAccessView* uav, unsigned int appendConsumeOffset = -1);
+	bool SetUnorderedAccessView(std::string_view name, ID3D11UnorderedAccessView* uav, unsigned int appendConsumeOffset = -1);
 
-	int GetUnorderedAccessViewIndex(std::string name);
+	int GetUnorderedAccessViewIndex(std::string_view name);
 
 protected:
+	SHADER_TYPE GetShaderType() const { return SHADER_TYPE::COMPUTE_SHADER; }
 	bool CreateShader(ID3DBlob* shaderBlob);
 	void SetShaderAndCBs();
 	void CleanUp();
+	void SwapContents(ShaderResource& other);
 
 protected:
 	ID3D11ComputeShader* shader{};
-	std::unordered_map<std::string, unsigned int> uavTable;
+	std::unordered_map<uint32, unsigned int> uavTable;
 
 	unsigned int threadsX{};
 	unsigned int threadsY{};
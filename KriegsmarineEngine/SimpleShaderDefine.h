@@ -7,7 +7,11 @@
 #include <vector>
 #include <string>
 #include <array>
+#include <cstdint>
+#include <string_view>
 #include "TypeDefinition.h"
+#include "ConstantBufferUpload.h"
+#include "ConstantBufferRing.h"
 
 enum class SHADER_TYPE
 {
@@ -17,6 +21,66 @@ enum class SHADER_TYPE
     HULL_SHADER,
     GEOMETRY_SHADER,
     COMPUTE_SHADER,
+    COUNT,
+};
+
+// --------------------------------------------------------
+// FNV-1a hash of a shader variable or resource name. All
+// reflection tables are keyed by it, so a name known at
+// compile time never needs to be hashed at run time.
+// --------------------------------------------------------
+constexpr uint32 HashShaderName(std::string_view name)
+{
+    uint32 hash = 2166136261u;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// --------------------------------------------------------
+// A name hashed at compile time, e.g.
+// shader->SetData("world"_shader, worldMatrix);
+// --------------------------------------------------------
+struct ShaderName
+{
+    uint32 Hash{};
+};
+
+consteval ShaderName operator""_shader(const char* name, size_t length)
+{
+    return ShaderName{ HashShaderName(std::string_view(name, length)) };
+}
+
+// --------------------------------------------------------
+// Resolved constant buffer variable. Resolve it once with
+// GetVariableHandle and SetData(handle, ...) is a bounds
+// check and a memcpy. The handle keeps the name hash and
+// the reflection generation it was resolved against, so
+// after the shader is reloaded it falls back to a lookup.
+// --------------------------------------------------------
+struct ShaderVariableHandle
+{
+    uint32 NameHash{};
+    uint32 Index{ UINT32_MAX };
+    uint32 Generation{};
+
+    bool IsValid() const { return Index != UINT32_MAX; }
+};
+
+// --------------------------------------------------------
+// Resolved texture or sampler binding, same rules as
+// ShaderVariableHandle
+// --------------------------------------------------------
+struct ShaderBindingHandle
+{
+    uint32 NameHash{};
+    uint32 BindIndex{ UINT32_MAX };
+    uint32 Generation{};
+
+    bool IsValid() const { return BindIndex != UINT32_MAX; }
 };
 
 // --------------------------------------------------------
@@ -28,7 +92,6 @@ struct ConstantBufferVariable
     uint32 ByteOffset{};
     uint32 Size{};
     uint32 ConstantBufferIndex{};
-    uint32 ElementCount{};
 };
 
 // --------------------------------------------------------
@@ -43,7 +106,9 @@ struct ShaderConstantBuffer
     uint32 BindIndex{};
     ID3D11Buffer* ConstantBuffer{ nullptr };
     byte* LocalDataBuffer{ nullptr };
-    std::vector<ConstantBufferVariable> Variables;
+    ConstantBufferDirtyRange Dirty{};
+    // Where the data was last written when a ring is in use
+    ConstantBufferRing::Allocation RingAllocation{};
 };
 
 // --------------------------------------------------------
@@ -0,0 +1,93 @@
+#include "BindingSlots.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+    struct Range
+    {
+        uint32_t first;
+        uint32_t count;
+        std::vector<int> values;
+
+        bool operator==(const Range&) const = default;
+    };
+
+    template <uint32_t SlotCount>
+    std::vector<Range> Commit(BindingSlots<int, SlotCount>& slots)
+    {
+        std::vector<Range> ranges;
+        slots.Commit([&ranges](uint32_t first, uint32_t count, const int* values)
+        {
+            ranges.push_back({ first, count, std::vector<int>(values, values + count) });
+        });
+        return ranges;
+    }
+}
+
+TEST(BindingSlots, ContiguousSlotsGoOutAsOneRange)
+{
+    BindingSlots<int, 8> slots;
+    slots.Request(2, 20);
+    slots.Request(3, 30);
+    slots.Request(4, 40);
+    slots.Request(6, 60);
+
+    std::vector<Range> expected{ { 2, 3, { 20, 30, 40 } }, { 6, 1, { 60 } } };
+    EXPECT_EQ(Commit(slots), expected);
+    EXPECT_FALSE(slots.HasPending());
+}
+
+TEST(BindingSlots, BoundValuesAreElided)
+{
+    BindingSlots<int, 8> slots;
+    slots.Request(0, 1);
+    slots.Request(1, 2);
+    Commit(slots);
+
+    slots.Request(0, 1);
+    slots.Request(1, 3);
+
+    std::vector<Range> expected{ { 1, 1, { 3 } } };
+    EXPECT_EQ(Commit(slots), expected);
+}
+
+TEST(BindingSlots, UnchangedSlotSplitsRange)
+{
+    BindingSlots<int, 8> slots;
+    slots.Request(1, 10);
+    Commit(slots);
+
+    slots.Request(0, 1);
+    slots.Request(1, 10);
+    slots.Request(2, 3);
+
+    std::vector<Range> expected{ { 0, 1, { 1 } }, { 2, 1, { 3 } } };
+    EXPECT_EQ(Commit(slots), expected);
+}
+
+TEST(BindingSlots, InvalidatedSlotsAreBoundAgain)
+{
+    BindingSlots<int, 8> slots;
+    slots.Request(0, 1);
+    slots.Request(1, 2);
+    Commit(slots);
+
+    // e.g. a UAV bind unbound the views behind the cache's back
+    slots.Invalidate();
+    slots.Request(0, 1);
+    slots.Request(1, 2);
+
+    std::vector<Range> expected{ { 0, 2, { 1, 2 } } };
+    EXPECT_EQ(Commit(slots), expected);
+}
+
+TEST(BindingSlots, LastRequestForASlotWins)
+{
+    BindingSlots<int, 8> slots;
+    slots.Request(5, 1);
+    slots.Request(5, 2);
+
+    std::vector<Range> expected{ { 5, 1, { 2 } } };
+    EXPECT_EQ(Commit(slots), expected);
+}
@@ -0,0 +1,154 @@
+#include "ConstantBufferUpload.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // Stands in for the device context: keeps a GPU side copy of the
+    // buffer and records every upload made to it
+    class RecordingDevice
+    {
+    public:
+        struct Upload
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+    public:
+        explicit RecordingDevice(uint32_t size) : gpuData(size) {}
+
+        auto Uploader(const std::vector<uint8_t>& cpuData)
+        {
+            return [this, &cpuData](uint32_t offset, uint32_t size)
+            {
+                uploads.push_back({ offset, size });
+                std::memcpy(gpuData.data() + offset, cpuData.data() + offset, size);
+            };
+        }
+
+        std::vector<Upload> uploads;
+        std::vector<uint8_t> gpuData;
+    };
+
+    struct TestBuffer
+    {
+        explicit TestBuffer(uint32_t size) : Size(size), cpuData(size) {}
+
+        void Set(uint32_t offset, const void* data, uint32_t size)
+        {
+            std::memcpy(cpuData.data() + offset, data, size);
+            Dirty.Mark(offset, size);
+        }
+
+        uint32_t Size;
+        ConstantBufferDirtyRange Dirty;
+        std::vector<uint8_t> cpuData;
+    };
+}
+
+TEST(ConstantBufferUpload, CleanBufferIsSkipped)
+{
+    ConstantBufferUploadStats stats;
+    TestBuffer buffer(64);
+    RecordingDevice device(64);
+
+    EXPECT_EQ(UploadIfDirty(buffer, true, device.Uploader(buffer.cpuData), stats), 0u);
+    EXPECT_TRUE(device.uploads.empty());
+    EXPECT_EQ(stats.GetCurrentFrame().skipped, 1u);
+    EXPECT_EQ(stats.GetCurrentFrame().uploads, 0u);
+}
+
+TEST(ConstantBufferUpload, PartialUpdateCoversWholeConstants)
+{
+    ConstantBufferUploadStats stats;
+    TestBuffer buffer(64);
+    RecordingDevice device(64);
+
+    float value = 1.0f;
+    buffer.Set(20, &value, sizeof(value));
+
+    EXPECT_EQ(UploadIfDirty(buffer, true, device.Uploader(buffer.cpuData), stats), 16u);
+    ASSERT_EQ(device.uploads.size(), 1u);
+    EXPECT_EQ(device.uploads[0].offset, 16u);
+    EXPECT_EQ(device.uploads[0].size, 16u);
+    EXPECT_EQ(std::memcmp(device.gpuData.data() + 20, &value, sizeof(value)), 0);
+    EXPECT_FALSE(buffer.Dirty.IsDirty());
+}
+
+TEST(ConstantBufferUpload, PartialUpdateIsClampedToTheBuffer)
+{
+    ConstantBufferUploadStats stats;
+    TestBuffer buffer(40);
+    RecordingDevice device(40);
+
+    uint32_t value = 7;
+    buffer.Set(36, &value, sizeof(value));
+
+    UploadIfDirty(buffer, true, device.Uploader(buffer.cpuData), stats);
+    ASSERT_EQ(device.uploads.size(), 1u);
+    EXPECT_EQ(device.uploads[0].offset, 32u);
+    EXPECT_EQ(device.uploads[0].size, 8u);
+}
+
+TEST(ConstantBufferUpload, WholeBufferWithoutPartialUpdates)
+{
+    ConstantBufferUploadStats stats;
+    TestBuffer buffer(64);
+    RecordingDevice device(64);
+
+    uint32_t value = 3;
+    buffer.Set(4, &value, sizeof(value));
+
+    EXPECT_EQ(UploadIfDirty(buffer, false, device.Uploader(buffer.cpuData), stats), 64u);
+    ASSERT_EQ(device.uploads.size(), 1u);
+    EXPECT_EQ(device.uploads[0].offset, 0u);
+    EXPECT_EQ(device.uploads[0].size, 64u);
+}
+
+TEST(ConstantBufferUpload, SecondUploadWithoutChangesIsSkipped)
+{
+    ConstantBufferUploadStats stats;
+    TestBuffer buffer(32);
+    RecordingDevice device(32);
+
+    uint32_t value = 5;
+    buffer.Set(0, &value, sizeof(value));
+    UploadIfDirty(buffer, true, device.Uploader(buffer.cpuData), stats);
+    UploadIfDirty(buffer, true, device.Uploader(buffer.cpuData), stats);
+
+    EXPECT_EQ(device.uploads.size(), 1u);
+    ConstantBufferUploadStats::Counters counters = stats.GetCurrentFrame();
+    EXPECT_EQ(counters.uploads, 1u);
+    EXPECT_EQ(counters.skipped, 1u);
+    EXPECT_EQ(counters.bytesUploaded, 16u);
+}
+
+TEST(ConstantBufferUpload, DirtyRangesMerge)
+{
+    ConstantBufferDirtyRange range;
+    EXPECT_FALSE(range.IsDirty());
+
+    range.Mark(32, 4);
+    range.Mark(8, 4);
+    EXPECT_TRUE(range.IsDirty());
+    EXPECT_EQ(range.Begin, 8u);
+    EXPECT_EQ(range.End, 36u);
+}
+
+TEST(ConstantBufferUploadStats, GlobalStatsRollOverOnFrameBegin)
+{
+    ConstantBufferUploadStats& stats = ConstantBufferUploadStats::GetGlobal();
+    FrameListenerRegistry::GetGlobal().BeginFrame();
+
+    stats.RecordUpload(48);
+    stats.RecordSkip();
+    FrameListenerRegistry::GetGlobal().BeginFrame();
+
+    ConstantBufferUploadStats::Counters last = stats.GetLastFrame();
+    EXPECT_EQ(last.uploads, 1u);
+    EXPECT_EQ(last.skipped, 1u);
+    EXPECT_EQ(last.bytesUploaded, 48u);
+    EXPECT_EQ(stats.GetCurrentFrame().uploads, 0u);
+}
@@ -0,0 +1,96 @@
+#include "FileWatcher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    class FileWatcherTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            // one per test, ctest may run them side by side
+            directory = fs::temp_directory_path() / "FileWatcherTests" /
+                testing::UnitTest::GetInstance()->current_test_info()->name();
+            fs::remove_all(directory);
+            fs::create_directories(directory);
+            directory = fs::canonical(directory);
+        }
+
+        void TearDown() override { fs::remove_all(directory); }
+
+        static void Write(const fs::path& path, const char* text) { std::ofstream(path) << text; }
+
+        // Polls until something shows up, as the notification may trail the write
+        static std::vector<fs::path> PollFor(FileWatcher& watcher, std::chrono::milliseconds timeout = std::chrono::seconds(2))
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            std::vector<fs::path> changed;
+            while (changed.empty() && std::chrono::steady_clock::now() < deadline)
+            {
+                changed = watcher.Poll();
+                if (changed.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            return changed;
+        }
+
+        fs::path directory;
+    };
+}
+
+TEST_F(FileWatcherTest, MissingDirectoryCantBeWatched)
+{
+    FileWatcher watcher;
+    EXPECT_FALSE(watcher.AddDirectory(directory / "missing"));
+}
+
+TEST_F(FileWatcherTest, NothingChanged)
+{
+    FileWatcher watcher;
+    ASSERT_TRUE(watcher.AddDirectory(directory));
+    EXPECT_TRUE(watcher.Poll().empty());
+}
+
+TEST_F(FileWatcherTest, ReportsWrittenFileOnce)
+{
+    FileWatcher watcher;
+    ASSERT_TRUE(watcher.AddDirectory(directory));
+    ASSERT_TRUE(watcher.AddDirectory(directory));
+
+    Write(directory / "Lit.hlsl", "one");
+    Write(directory / "Lit.hlsl", "two");
+
+    std::vector<fs::path> changed = PollFor(watcher);
+    EXPECT_EQ(changed, std::vector<fs::path>{ directory / "Lit.hlsl" });
+    EXPECT_TRUE(watcher.Poll().empty());
+}
+
+TEST_F(FileWatcherTest, ReportsFileRenamedIntoPlace)
+{
+    fs::path staging = directory.parent_path() / "ReportsFileRenamedIntoPlace.staging";
+    Write(staging, "saved elsewhere");
+
+    FileWatcher watcher;
+    ASSERT_TRUE(watcher.AddDirectory(directory));
+
+    fs::rename(staging, directory / "Sky.hlsl");
+    EXPECT_EQ(PollFor(watcher), std::vector<fs::path>{ directory / "Sky.hlsl" });
+}
+
+TEST_F(FileWatcherTest, SubdirectoriesAreNotWatched)
+{
+    fs::create_directories(directory / "nested");
+
+    FileWatcher watcher;
+    ASSERT_TRUE(watcher.AddDirectory(directory));
+
+    Write(directory / "nested" / "Lit.hlsl", "nested");
+    Write(directory / "Sky.hlsl", "top");
+
+    EXPECT_EQ(PollFor(watcher), std::vector<fs::path>{ directory / "Sky.hlsl" });
+}
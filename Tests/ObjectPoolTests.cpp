@@ -0,0 +1,87 @@
+#include "ObjectPool.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace
+{
+    struct Tracked
+    {
+        explicit Tracked(int value, bool fail = false) : value(value)
+        {
+            if (fail) throw std::runtime_error("construction failed");
+            ++alive;
+        }
+        ~Tracked() { --alive; }
+
+        int value;
+        static inline int alive = 0;
+    };
+}
+
+TEST(ObjectPool, CreateGetDestroy)
+{
+    ObjectPool<Tracked, 4> pool;
+    Handle<Tracked> a = pool.Create(1);
+    Handle<Tracked> b = pool.Create(2);
+
+    ASSERT_NE(pool.Get(a), nullptr);
+    EXPECT_EQ(pool.Get(a)->value, 1);
+    EXPECT_EQ(pool.Get(b)->value, 2);
+    EXPECT_EQ(pool.Size(), 2u);
+
+    pool.Destroy(a);
+    EXPECT_EQ(pool.Get(a), nullptr);
+    EXPECT_EQ(pool.Size(), 1u);
+    EXPECT_EQ(Tracked::alive, 1);
+}
+
+TEST(ObjectPool, ReusedSlotInvalidatesOldHandle)
+{
+    ObjectPool<Tracked, 4> pool;
+    Handle<Tracked> a = pool.Create(1);
+    pool.Destroy(a);
+
+    Handle<Tracked> b = pool.Create(2);
+    EXPECT_EQ(a.GetIndex(), b.GetIndex());
+    EXPECT_FALSE(pool.IsValid(a));
+    EXPECT_EQ(pool.Get(b)->value, 2);
+}
+
+TEST(ObjectPool, ThrowingConstructorLosesNoSlot)
+{
+    ObjectPool<Tracked, 2> pool;
+    Handle<Tracked> a = pool.Create(1);
+
+    // a fresh slot, then a reused one
+    EXPECT_THROW(pool.Create(2, true), std::runtime_error);
+    EXPECT_EQ(pool.Size(), 1u);
+
+    pool.Destroy(a);
+    EXPECT_THROW(pool.Create(3, true), std::runtime_error);
+    EXPECT_EQ(pool.Size(), 0u);
+
+    // both slots are still there to be used, in the first chunk
+    Handle<Tracked> b = pool.Create(4);
+    Handle<Tracked> c = pool.Create(5);
+    EXPECT_LT(b.GetIndex(), 2u);
+    EXPECT_LT(c.GetIndex(), 2u);
+    EXPECT_NE(b.GetIndex(), c.GetIndex());
+    EXPECT_EQ(pool.Size(), 2u);
+
+    int sum = 0;
+    pool.ForEach([&sum](Tracked& tracked) { sum += tracked.value; });
+    EXPECT_EQ(sum, 9);
+}
+
+TEST(ObjectPool, ClearDestroysEverything)
+{
+    {
+        ObjectPool<Tracked, 4> pool;
+        for (int i = 0; i < 10; i++)
+        {
+            pool.Create(i);
+        }
+        EXPECT_EQ(Tracked::alive, 10);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
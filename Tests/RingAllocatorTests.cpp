@@ -0,0 +1,99 @@
+#include "RingAllocator.h"
+#include <gtest/gtest.h>
+
+TEST(RingAllocator, FirstAllocationStartsTheRing)
+{
+    RingAllocator ring(1024, 2);
+
+    RingAllocator::Allocation first = ring.Allocate(100, 16);
+    ASSERT_TRUE(first.IsValid());
+    EXPECT_EQ(first.offset, 0u);
+    EXPECT_TRUE(first.wrapped);
+
+    RingAllocator::Allocation second = ring.Allocate(100, 16);
+    ASSERT_TRUE(second.IsValid());
+    EXPECT_EQ(second.offset, 112u);
+    EXPECT_FALSE(second.wrapped);
+    EXPECT_EQ(ring.GetUsedBytes(), 212u);
+}
+
+TEST(RingAllocator, OversizedRequestFails)
+{
+    RingAllocator ring(256, 2);
+    EXPECT_FALSE(ring.Allocate(257).IsValid());
+}
+
+TEST(RingAllocator, FullRingFailsUntilAFrameRetires)
+{
+    RingAllocator ring(1024, 1);
+
+    ASSERT_TRUE(ring.Allocate(512).IsValid());
+    ASSERT_TRUE(ring.Allocate(512).IsValid());
+    EXPECT_FALSE(ring.Allocate(16).IsValid());
+
+    // closing the frame doesn't free it, it is in flight for one more frame
+    ring.BeginFrame();
+    EXPECT_FALSE(ring.Allocate(16).IsValid());
+
+    ring.BeginFrame();
+    EXPECT_EQ(ring.GetUsedBytes(), 0u);
+    EXPECT_TRUE(ring.Allocate(16).IsValid());
+}
+
+TEST(RingAllocator, FramesRetireAfterTheLatency)
+{
+    RingAllocator ring(4096, 2);
+
+    ring.Allocate(1024);
+    ring.BeginFrame();
+    ring.Allocate(1024);
+    ring.BeginFrame();
+    ring.Allocate(1024);
+    ring.BeginFrame();
+    // the first frame is reclaimed once frameLatency more frames have been closed after it
+    EXPECT_EQ(ring.GetUsedBytes(), 2048u);
+
+    ring.BeginFrame();
+    EXPECT_EQ(ring.GetUsedBytes(), 1024u);
+    ring.BeginFrame();
+    EXPECT_EQ(ring.GetUsedBytes(), 0u);
+}
+
+TEST(RingAllocator, WrapSkipsTheTailOfTheRing)
+{
+    RingAllocator ring(1024, 1);
+
+    ASSERT_TRUE(ring.Allocate(768).IsValid());
+    ring.BeginFrame();
+    ring.BeginFrame();
+
+    // 256 bytes left before the end; 512 don't fit there, so the ring wraps to 0
+    RingAllocator::Allocation wrapped = ring.Allocate(512);
+    ASSERT_TRUE(wrapped.IsValid());
+    EXPECT_EQ(wrapped.offset, 0u);
+    EXPECT_TRUE(wrapped.wrapped);
+    // the skipped 256 bytes count as used until this frame retires
+    EXPECT_EQ(ring.GetUsedBytes(), 768u);
+}
+
+TEST(RingAllocator, WrapDoesNotOverwriteAFrameInFlight)
+{
+    RingAllocator ring(1024, 2);
+
+    ASSERT_TRUE(ring.Allocate(768).IsValid());
+    ring.BeginFrame();
+
+    // the 768 bytes of the last frame are still in flight; wrapping would overwrite them
+    EXPECT_FALSE(ring.Allocate(512).IsValid());
+    EXPECT_TRUE(ring.Allocate(256).IsValid());
+}
+
+TEST(RingAllocator, AlignmentPadsTheOffset)
+{
+    RingAllocator ring(1024, 1);
+
+    ring.Allocate(10, 1);
+    RingAllocator::Allocation aligned = ring.Allocate(16, 256);
+    ASSERT_TRUE(aligned.IsValid());
+    EXPECT_EQ(aligned.offset, 256u);
+}
@@ -0,0 +1,189 @@
+#include "ShaderPermutationKey.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+
+TEST(ShaderDefineTable, AddAssignsBitsInOrder)
+{
+    ShaderDefineTable defines;
+    EXPECT_EQ(defines.Add("NORMAL_MAP"), 0u);
+    EXPECT_EQ(defines.Add("SKINNED"), 1u);
+    EXPECT_EQ(defines.Add("NORMAL_MAP"), 0u);
+    EXPECT_EQ(defines.GetCount(), 2u);
+    EXPECT_EQ(defines.GetName(1), "SKINNED");
+    EXPECT_EQ(defines.GetBit("FOG"), ShaderDefineTable::INVALID_BIT);
+}
+
+TEST(ShaderDefineTable, FullTableRejectsNewDefines)
+{
+    ShaderDefineTable defines;
+    for (uint32_t i = 0; i < ShaderDefineTable::MAX_DEFINES; i++)
+    {
+        EXPECT_EQ(defines.Add("D" + std::to_string(i)), i);
+    }
+
+    EXPECT_EQ(defines.Add("ONE_TOO_MANY"), ShaderDefineTable::INVALID_BIT);
+    EXPECT_EQ(defines.Add("D63"), 63u);
+    EXPECT_TRUE(defines.IsValidKey(~ShaderPermutationKey(0)));
+}
+
+TEST(ShaderDefineTable, MakeKeyIgnoresUnknownNames)
+{
+    ShaderDefineTable defines;
+    defines.Add("A");
+    defines.Add("B");
+    defines.Add("C");
+
+    EXPECT_EQ(defines.MakeKey({ "C", "A", "UNKNOWN" }), 0b101u);
+    EXPECT_EQ(defines.MakeKey({}), 0u);
+}
+
+TEST(ShaderDefineTable, ForEachDefineVisitsSetBitsInOrder)
+{
+    ShaderDefineTable defines;
+    defines.Add("A");
+    defines.Add("B");
+    defines.Add("C");
+
+    std::vector<std::string> visited;
+    defines.ForEachDefine(0b101, [&visited](const std::string& name) { visited.push_back(name); });
+    EXPECT_EQ(visited, (std::vector<std::string>{ "A", "C" }));
+}
+
+TEST(ShaderDefineTable, KeysWithUnknownBitsAreInvalid)
+{
+    ShaderDefineTable defines;
+    EXPECT_TRUE(defines.IsValidKey(0));
+    EXPECT_FALSE(defines.IsValidKey(1));
+
+    defines.Add("A");
+    defines.Add("B");
+    EXPECT_TRUE(defines.IsValidKey(0b11));
+    EXPECT_FALSE(defines.IsValidKey(0b100));
+}
+
+TEST(ShaderDefineTable, HashDependsOnNamesAndOrder)
+{
+    ShaderDefineTable ab;
+    ab.Add("A");
+    ab.Add("B");
+
+    ShaderDefineTable sameAb;
+    sameAb.Add("A");
+    sameAb.Add("B");
+
+    ShaderDefineTable ba;
+    ba.Add("B");
+    ba.Add("A");
+
+    ShaderDefineTable joined;
+    joined.Add("AB");
+
+    EXPECT_EQ(ab.GetHash(), sameAb.GetHash());
+    EXPECT_NE(ab.GetHash(), ba.GetHash());
+    EXPECT_NE(ab.GetHash(), joined.GetHash());
+    EXPECT_NE(ab.GetHash(), ShaderDefineTable().GetHash());
+}
+
+TEST(FormatPermutationKey, FixedWidthLowercaseHex)
+{
+    EXPECT_EQ(FormatPermutationKey(0), "0000000000000000");
+    EXPECT_EQ(FormatPermutationKey(0xABCull), "0000000000000abc");
+    EXPECT_EQ(FormatPermutationKey(~ShaderPermutationKey(0)), "ffffffffffffffff");
+    EXPECT_EQ(FormatPermutationKey(0x0123456789ABCDEFull), "0123456789abcdef");
+}
+
+TEST(IsShaderCacheCurrent, ComparesWriteTimes)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "ShaderPermutationKeyTests";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path source = directory / "Lit.hlsl";
+    std::filesystem::path cache = directory / "Lit.cso";
+    std::ofstream(source) << "source";
+    std::ofstream(cache) << "blob";
+
+    auto now = std::filesystem::last_write_time(source);
+    std::filesystem::last_write_time(cache, now);
+    EXPECT_TRUE(IsShaderCacheCurrent(cache, source));
+
+    std::filesystem::last_write_time(source, now + std::chrono::seconds(1));
+    EXPECT_FALSE(IsShaderCacheCurrent(cache, source));
+
+    std::filesystem::remove(cache);
+    EXPECT_FALSE(IsShaderCacheCurrent(cache, source));
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ShaderVariantCache, FindMissReturnsNull)
+{
+    ShaderVariantCache<int> cache(2);
+    EXPECT_EQ(cache.Find(1), nullptr);
+    EXPECT_EQ(cache.GetCapacity(), 2u);
+    EXPECT_EQ(ShaderVariantCache<int>(0).GetCapacity(), 1u);
+}
+
+TEST(ShaderVariantCache, EvictsLeastRecentlyUsed)
+{
+    ShaderVariantCache<int> cache(2);
+    cache.Insert(1, 10);
+    cache.Insert(2, 20);
+
+    // touching 1 leaves 2 as the oldest
+    ASSERT_NE(cache.Find(1), nullptr);
+    cache.Insert(3, 30);
+
+    EXPECT_EQ(cache.GetSize(), 2u);
+    EXPECT_EQ(cache.Find(2), nullptr);
+    ASSERT_NE(cache.Find(1), nullptr);
+    EXPECT_EQ(*cache.Find(1), 10);
+    ASSERT_NE(cache.Find(3), nullptr);
+    EXPECT_EQ(*cache.Find(3), 30);
+}
+
+TEST(ShaderVariantCache, InsertReplacesAndRefreshes)
+{
+    ShaderVariantCache<int> cache(2);
+    cache.Insert(1, 10);
+    cache.Insert(2, 20);
+
+    EXPECT_EQ(cache.Insert(1, 11), 11);
+    EXPECT_EQ(cache.GetSize(), 2u);
+
+    cache.Insert(3, 30);
+    EXPECT_EQ(cache.Find(2), nullptr);
+    ASSERT_NE(cache.Find(1), nullptr);
+    EXPECT_EQ(*cache.Find(1), 11);
+}
+
+TEST(ShaderVariantCache, EraseAndClear)
+{
+    ShaderVariantCache<int> cache(3);
+    cache.Insert(1, 10);
+    cache.Insert(2, 20);
+
+    cache.Erase(1);
+    cache.Erase(42);
+    EXPECT_EQ(cache.Find(1), nullptr);
+    EXPECT_EQ(cache.GetSize(), 1u);
+
+    // the erased entry's place in the order is gone too
+    cache.Insert(3, 30);
+    cache.Insert(4, 40);
+    EXPECT_EQ(cache.GetSize(), 3u);
+
+    cache.Clear();
+    EXPECT_EQ(cache.GetSize(), 0u);
+    EXPECT_EQ(cache.Find(2), nullptr);
+}
+
+TEST(ShaderVariantCache, EvictedValueOutlivesItsEntry)
+{
+    ShaderVariantCache<std::shared_ptr<int>> cache(1);
+    std::shared_ptr<int> held = cache.Insert(1, std::make_shared<int>(10));
+    cache.Insert(2, std::make_shared<int>(20));
+
+    EXPECT_EQ(cache.Find(1), nullptr);
+    EXPECT_EQ(held.use_count(), 1);
+    EXPECT_EQ(*held, 10);
+}
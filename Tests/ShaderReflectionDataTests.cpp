@@ -0,0 +1,182 @@
+#include "ShaderReflectionData.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+namespace
+{
+    ShaderReflectionData MakeReflection()
+    {
+        ShaderReflectionData reflection;
+        reflection.BlobHash = 0x0123456789ABCDEFull;
+
+        ShaderReflectionConstantBuffer perObject;
+        perObject.Name = "perObject";
+        perObject.NameHash = 11;
+        perObject.BindPoint = 0;
+        perObject.Size = 128;
+        perObject.Variables = { { 21, 0, 64 }, { 22, 64, 64 } };
+
+        ShaderReflectionConstantBuffer perFrame;
+        perFrame.Name = "perFrame";
+        perFrame.NameHash = 12;
+        perFrame.BindPoint = 1;
+        perFrame.Size = 16;
+        perFrame.Variables = { { 23, 0, 12 } };
+
+        reflection.ConstantBuffers = { perObject, perFrame };
+        reflection.Textures = { { 31, 0 }, { 32, 3 } };
+        reflection.Samplers = { { 41, 0 } };
+        reflection.UnorderedAccessViews = { { 51, 1 } };
+        reflection.InputParameters = { { "POSITION", 0, 3, 0x7 }, { "TEXCOORD", 1, 3, 0x3 } };
+        reflection.ThreadGroupSize = { 8, 8, 1 };
+        return reflection;
+    }
+
+    void ExpectBindingsEqual(const std::vector<ShaderReflectionBinding>& a, const std::vector<ShaderReflectionBinding>& b)
+    {
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            EXPECT_EQ(a[i].NameHash, b[i].NameHash);
+            EXPECT_EQ(a[i].BindPoint, b[i].BindPoint);
+        }
+    }
+
+    void ExpectReflectionEqual(const ShaderReflectionData& a, const ShaderReflectionData& b)
+    {
+        EXPECT_EQ(a.BlobHash, b.BlobHash);
+        EXPECT_EQ(a.ThreadGroupSize, b.ThreadGroupSize);
+
+        ASSERT_EQ(a.ConstantBuffers.size(), b.ConstantBuffers.size());
+        for (size_t i = 0; i < a.ConstantBuffers.size(); i++)
+        {
+            const ShaderReflectionConstantBuffer& cbA = a.ConstantBuffers[i];
+            const ShaderReflectionConstantBuffer& cbB = b.ConstantBuffers[i];
+            EXPECT_EQ(cbA.Name, cbB.Name);
+            EXPECT_EQ(cbA.NameHash, cbB.NameHash);
+            EXPECT_EQ(cbA.BindPoint, cbB.BindPoint);
+            EXPECT_EQ(cbA.Size, cbB.Size);
+
+            ASSERT_EQ(cbA.Variables.size(), cbB.Variables.size());
+            for (size_t v = 0; v < cbA.Variables.size(); v++)
+            {
+                EXPECT_EQ(cbA.Variables[v].NameHash, cbB.Variables[v].NameHash);
+                EXPECT_EQ(cbA.Variables[v].ByteOffset, cbB.Variables[v].ByteOffset);
+                EXPECT_EQ(cbA.Variables[v].Size, cbB.Variables[v].Size);
+            }
+        }
+
+        ExpectBindingsEqual(a.Textures, b.Textures);
+        ExpectBindingsEqual(a.Samplers, b.Samplers);
+        ExpectBindingsEqual(a.UnorderedAccessViews, b.UnorderedAccessViews);
+
+        ASSERT_EQ(a.InputParameters.size(), b.InputParameters.size());
+        for (size_t i = 0; i < a.InputParameters.size(); i++)
+        {
+            EXPECT_EQ(a.InputParameters[i].SemanticName, b.InputParameters[i].SemanticName);
+            EXPECT_EQ(a.InputParameters[i].SemanticIndex, b.InputParameters[i].SemanticIndex);
+            EXPECT_EQ(a.InputParameters[i].ComponentType, b.InputParameters[i].ComponentType);
+            EXPECT_EQ(a.InputParameters[i].Mask, b.InputParameters[i].Mask);
+        }
+    }
+}
+
+TEST(ShaderReflectionData, RoundTrip)
+{
+    ShaderReflectionData written = MakeReflection();
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+
+    ShaderReflectionData read;
+    ASSERT_TRUE(ReadShaderReflection(data.data(), data.size(), written.BlobHash, read));
+    ExpectReflectionEqual(written, read);
+}
+
+TEST(ShaderReflectionData, EmptyRoundTrip)
+{
+    ShaderReflectionData written;
+    written.BlobHash = 7;
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+
+    ShaderReflectionData read = MakeReflection();
+    ASSERT_TRUE(ReadShaderReflection(data.data(), data.size(), 7, read));
+    ExpectReflectionEqual(written, read);
+}
+
+TEST(ShaderReflectionData, EveryTruncationIsRejected)
+{
+    ShaderReflectionData written = MakeReflection();
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        ShaderReflectionData read;
+        EXPECT_FALSE(ReadShaderReflection(data.data(), size, written.BlobHash, read)) << "truncated to " << size << " bytes";
+    }
+}
+
+TEST(ShaderReflectionData, TrailingBytesAreRejected)
+{
+    ShaderReflectionData written = MakeReflection();
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+    data.push_back(0);
+
+    ShaderReflectionData read;
+    EXPECT_FALSE(ReadShaderReflection(data.data(), data.size(), written.BlobHash, read));
+}
+
+TEST(ShaderReflectionData, WrongBlobHashIsRejected)
+{
+    ShaderReflectionData written = MakeReflection();
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+
+    ShaderReflectionData read;
+    EXPECT_FALSE(ReadShaderReflection(data.data(), data.size(), written.BlobHash + 1, read));
+}
+
+TEST(ShaderReflectionData, WrongMagicIsRejected)
+{
+    ShaderReflectionData written = MakeReflection();
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+    data[0] ^= 0xFF;
+
+    ShaderReflectionData read;
+    EXPECT_FALSE(ReadShaderReflection(data.data(), data.size(), written.BlobHash, read));
+}
+
+TEST(ShaderReflectionData, HugeCountIsRejected)
+{
+    ShaderReflectionData written;
+    written.BlobHash = 7;
+    std::vector<uint8_t> data = WriteShaderReflection(written);
+
+    // ConstantBufferCount follows magic, version, reserved, hash and thread group size
+    uint32_t count = UINT32_MAX;
+    std::memcpy(data.data() + 4 + 2 + 2 + 8 + 12, &count, sizeof(count));
+
+    ShaderReflectionData read;
+    EXPECT_FALSE(ReadShaderReflection(data.data(), data.size(), 7, read));
+}
+
+TEST(ShaderReflectionData, SaveAndLoadFile)
+{
+    std::filesystem::path shaderFile = std::filesystem::temp_directory_path() / "ShaderReflectionDataTests.cso";
+    std::filesystem::path path = GetShaderReflectionPath(shaderFile);
+    EXPECT_EQ(path.filename(), "ShaderReflectionDataTests.cso.refl");
+
+    ShaderReflectionData written = MakeReflection();
+    ASSERT_TRUE(SaveShaderReflection(path, written));
+
+    ShaderReflectionData read;
+    EXPECT_TRUE(LoadShaderReflection(path, written.BlobHash, read));
+    ExpectReflectionEqual(written, read);
+    EXPECT_FALSE(LoadShaderReflection(path, written.BlobHash + 1, read));
+
+    std::filesystem::remove(path);
+    EXPECT_FALSE(LoadShaderReflection(path, written.BlobHash, read));
+}
+
+TEST(ShaderReflectionData, BlobHashIsFnv1a)
+{
+    EXPECT_EQ(HashShaderBlob(nullptr, 0), 14695981039346656037ull);
+    EXPECT_EQ(HashShaderBlob("a", 1), 0xAF63DC4C8601EC8Cull);
+}
@@ -0,0 +1,135 @@
+#include "ShaderReloadSchedule.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Schedule = ShaderReloadSchedule<std::string>;
+    using namespace std::chrono_literals;
+
+    constexpr std::chrono::milliseconds SETTLE_TIME{ 100 };
+
+    const std::filesystem::path SHADERS = std::filesystem::path("/shaders");
+    const std::filesystem::path OTHER = std::filesystem::path("/other");
+
+    std::vector<std::string> StartDue(Schedule& schedule, Schedule::Clock::time_point now)
+    {
+        std::vector<std::string> started;
+        schedule.StartDue(now, [&started](Schedule::Entry& entry) { started.push_back(entry.target); });
+        return started;
+    }
+
+    Schedule::Entry& Find(Schedule& schedule, const std::string& target)
+    {
+        for (Schedule::Entry& entry : schedule.GetEntries())
+        {
+            if (entry.target == target) return entry;
+        }
+        throw std::out_of_range(target);
+    }
+}
+
+TEST(ShaderReloadSchedule, NothingChangedNothingStarts)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+
+    EXPECT_TRUE(StartDue(schedule, Schedule::Clock::now() + 1h).empty());
+}
+
+TEST(ShaderReloadSchedule, ReloadWaitsForTheSettleTime)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+
+    auto now = Schedule::Clock::now();
+    schedule.MarkChanged(SHADERS / "Lit.hlsl", now);
+
+    EXPECT_TRUE(StartDue(schedule, now + SETTLE_TIME - 1ms).empty());
+    EXPECT_EQ(StartDue(schedule, now + SETTLE_TIME), std::vector<std::string>{ "lit" });
+}
+
+TEST(ShaderReloadSchedule, EveryWriteRestartsTheSettleTime)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+
+    auto now = Schedule::Clock::now();
+    schedule.MarkChanged(SHADERS / "Lit.hlsl", now);
+    schedule.MarkChanged(SHADERS / "Lit.hlsl", now + 80ms);
+
+    EXPECT_TRUE(StartDue(schedule, now + SETTLE_TIME).empty());
+    EXPECT_EQ(StartDue(schedule, now + 80ms + SETTLE_TIME), std::vector<std::string>{ "lit" });
+}
+
+TEST(ShaderReloadSchedule, OnlyTheChangedFileReloads)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+    schedule.Add(SHADERS / "Sky.hlsl", false, "sky");
+
+    auto now = Schedule::Clock::now();
+    schedule.MarkChanged(SHADERS / "Sky.hlsl", now);
+
+    EXPECT_EQ(StartDue(schedule, now + SETTLE_TIME), std::vector<std::string>{ "sky" });
+}
+
+TEST(ShaderReloadSchedule, IncludeReloadsSourcesInItsDirectory)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+    schedule.Add(SHADERS / "Sky.hlsl", false, "sky");
+    schedule.Add(SHADERS / "SkyVS.cso", true, "compiled");
+    schedule.Add(OTHER / "Water.hlsl", false, "water");
+
+    auto now = Schedule::Clock::now();
+    schedule.MarkChanged(SHADERS / "Lighting.hlsli", now);
+
+    EXPECT_EQ(StartDue(schedule, now + SETTLE_TIME), (std::vector<std::string>{ "lit", "sky" }));
+}
+
+TEST(ShaderReloadSchedule, IncludeExtensions)
+{
+    EXPECT_TRUE(Schedule::IsIncludeFile("a.hlsli"));
+    EXPECT_TRUE(Schedule::IsIncludeFile("a.fxh"));
+    EXPECT_TRUE(Schedule::IsIncludeFile("a.h"));
+    EXPECT_FALSE(Schedule::IsIncludeFile("a.hlsl"));
+    EXPECT_FALSE(Schedule::IsIncludeFile("a.cso"));
+}
+
+TEST(ShaderReloadSchedule, ChangeDuringReloadWaitsThenReloadsAgain)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+
+    auto now = Schedule::Clock::now();
+    schedule.MarkChanged(SHADERS / "Lit.hlsl", now);
+    ASSERT_EQ(StartDue(schedule, now + SETTLE_TIME).size(), 1u);
+
+    // saved again while the first reload is compiling
+    schedule.MarkChanged(SHADERS / "Lit.hlsl", now + SETTLE_TIME);
+    EXPECT_TRUE(StartDue(schedule, now + 1h).empty());
+
+    schedule.Finish(Find(schedule, "lit"));
+    EXPECT_EQ(StartDue(schedule, now + 1h), std::vector<std::string>{ "lit" });
+
+    // and only once
+    schedule.Finish(Find(schedule, "lit"));
+    EXPECT_TRUE(StartDue(schedule, now + 2h).empty());
+}
+
+TEST(ShaderReloadSchedule, RemovedEntriesNoLongerReload)
+{
+    Schedule schedule(SETTLE_TIME);
+    schedule.Add(SHADERS / "Lit.hlsl", false, "lit");
+    schedule.Add(SHADERS / "Sky.hlsl", false, "sky");
+
+    schedule.RemoveIf([](const Schedule::Entry& entry) { return entry.target == "lit"; });
+    EXPECT_EQ(schedule.GetEntries().size(), 1u);
+
+    auto now = Schedule::Clock::now();
+    schedule.MarkChanged(SHADERS / "Lighting.hlsli", now);
+    EXPECT_EQ(StartDue(schedule, now + SETTLE_TIME), std::vector<std::string>{ "sky" });
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "CpuPause.h"
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------
+// Spin-then-park mutex. The uncontended path is one CAS.
+// Under contention it spins on a relaxed load with
+// exponential backoff (test-and-test-and-set), and once the
+// spin budget is spent it parks on std::atomic::wait, which
+// maps to WaitOnAddress / futex, so a descheduled holder
+// doesn't burn the waiting core.
+// Satisfies Lockable: use with std::lock_guard / scoped_lock.
+// --------------------------------------------------------
+class AdaptiveLock
+{
+public:
+    struct Statistics
+    {
+        uint64_t contended{}; // lock() calls that missed the fast path
+        uint64_t parked{};    // times a waiter went to sleep
+    };
+
+private:
+    static constexpr uint32_t UNLOCKED = 0;
+    static constexpr uint32_t LOCKED = 1;
+    static constexpr uint32_t LOCKED_WITH_WAITERS = 2;
+
+public:
+    AdaptiveLock() = default;
+    AdaptiveLock(const AdaptiveLock&) = delete;
+    AdaptiveLock& operator=(const AdaptiveLock&) = delete;
+
+    void lock()
+    {
+        uint32_t expected = UNLOCKED;
+        if (!state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            lockContended();
+        }
+    }
+
+    bool try_lock()
+    {
+        uint32_t expected = UNLOCKED;
+        return state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock()
+    {
+        if (state.exchange(UNLOCKED, std::memory_order_release) == LOCKED_WITH_WAITERS)
+        {
+            state.notify_one();
+        }
+    }
+
+    Statistics GetStatistics() const
+    {
+        return { contended.load(std::memory_order_relaxed), parked.load(std::memory_order_relaxed) };
+    }
+
+private:
+    void lockContended()
+    {
+        contended.fetch_add(1, std::memory_order_relaxed);
+
+        Backoff backoff;
+        while (backoff.IsSpinning())
+        {
+            if (state.load(std::memory_order_relaxed) == UNLOCKED)
+            {
+                uint32_t expected = UNLOCKED;
+                if (state.compare_exchange_weak(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+            }
+            backoff.Pause();
+        }
+
+        // From here on we may be sleeping, so flag the lock so unlock() knows to wake someone.
+        while (state.exchange(LOCKED_WITH_WAITERS, std::memory_order_acquire) != UNLOCKED)
+        {
+            parked.fetch_add(1, std::memory_order_relaxed);
+            state.wait(LOCKED_WITH_WAITERS, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> state{ UNLOCKED };
+    std::atomic<uint64_t> contended{};
+    std::atomic<uint64_t> parked{};
+};
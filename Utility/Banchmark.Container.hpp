@@ -0,0 +1,135 @@
+#pragma once
+#include "Banchmark.hpp"
+#include "LinkedListLib.hpp"
+#include "UnrolledList.h"
+#include "IndexedList.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// --------------------------------------------------------
+// Iteration cost of LinkedList against UnrolledList and
+// IndexedList for membership lists of 10k ~ 100k elements.
+// Half of the elements are unlinked and relinked in random
+// order first, so the lists look like they do after a few
+// frames of churn rather than right after loading.
+// --------------------------------------------------------
+inline void RunContainerBanchmark(size_t iterations = 100)
+{
+    struct Item : LinkProperty<Item>
+    {
+        Item(size_t value) : LinkProperty<Item>(this), value(value) {}
+        size_t value;
+    };
+
+    struct PooledItem
+    {
+        size_t value{};
+        UnrolledListHook unrolledHook;
+        IndexedListHook indexedHook;
+    };
+
+    for (size_t count : { 10000, 50000, 100000 })
+    {
+        std::mt19937 random(static_cast<unsigned int>(count));
+        std::vector<size_t> churn(count / 2);
+        for (size_t i = 0; i < churn.size(); ++i)
+        {
+            churn[i] = i * 2;
+        }
+        std::shuffle(churn.begin(), churn.end(), random);
+
+        size_t sum = 0;
+        printf("%zu elements, %zu iterations\n", count, iterations);
+
+        {
+            std::vector<Item*> items;
+            LinkedList<Item> list;
+            for (size_t i = 0; i < count; ++i)
+            {
+                items.push_back(new Item(i));
+                list.Link(items.back());
+            }
+            for (size_t i : churn)
+            {
+                list.Unlink(items[i]);
+                list.Link(items[i]);
+            }
+
+            printf("LinkedList\n");
+            {
+                Banchmark banchmark;
+                for (size_t n = 0; n < iterations; ++n)
+                {
+                    for (auto& item : list)
+                    {
+                        sum += item.value;
+                    }
+                }
+            }
+
+            list.ClearLink();
+            for (Item* item : items)
+            {
+                delete item;
+            }
+        }
+
+        // the intrusive lists link elements that stay in one array, as pooled components would
+        std::vector<PooledItem> pooled(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            pooled[i].value = i;
+        }
+
+        {
+            UnrolledList<PooledItem, &PooledItem::unrolledHook> list;
+            for (PooledItem& item : pooled)
+            {
+                list.Link(item);
+            }
+            for (size_t i : churn)
+            {
+                list.Unlink(pooled[i]);
+                list.Link(pooled[i]);
+            }
+
+            printf("UnrolledList\n");
+            Banchmark banchmark;
+            for (size_t n = 0; n < iterations; ++n)
+            {
+                for (PooledItem& item : list)
+                {
+                    sum += item.value;
+                }
+            }
+        }
+
+        {
+            IndexedList<PooledItem, &PooledItem::indexedHook> list(pooled.data());
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                list.Link(i);
+            }
+            for (size_t i : churn)
+            {
+                list.Unlink(static_cast<uint32_t>(i));
+                list.Link(static_cast<uint32_t>(i));
+            }
+
+            printf("IndexedList\n");
+            Banchmark banchmark;
+            for (size_t n = 0; n < iterations; ++n)
+            {
+                for (PooledItem& item : list)
+                {
+                    sum += item.value;
+                }
+            }
+        }
+
+        volatile size_t sink = sum;
+        (void)sink;
+    }
+}
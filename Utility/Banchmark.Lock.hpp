@@ -0,0 +1,82 @@
+#pragma once
+#include "Banchmark.hpp"
+#include "ReaderWriterLock.h"
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// --------------------------------------------------------
+// Compares ReaderWriterLock and ShardedReaderWriterLock with
+// std::shared_mutex on a read-heavy lookup table, similar to
+// shader variable and component manager lookups.
+// writeEvery - one write per this many operations per thread
+// --------------------------------------------------------
+inline void RunReaderWriterLockBanchmark(size_t threadCount = 8, size_t operations = 1000000, size_t writeEvery = 1000)
+{
+    constexpr size_t keyCount = 1024;
+
+    auto run = [&](const char* name, auto&& read, auto&& write)
+        {
+            printf("%s (%zu threads, 1 write per %zu ops)\n", name, threadCount, writeEvery);
+            Banchmark banchmark;
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back([&, t]()
+                    {
+                        size_t sum = 0;
+                        for (size_t i = 0; i < operations; ++i)
+                        {
+                            size_t key = (i * 2654435761u + t) % keyCount;
+                            if (i % writeEvery == 0)
+                            {
+                                write(key);
+                            }
+                            else
+                            {
+                                sum += read(key);
+                            }
+                        }
+                        volatile size_t sink = sum;
+                        (void)sink;
+                    });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        };
+
+    std::unordered_map<size_t, size_t> table;
+    for (size_t key = 0; key < keyCount; ++key)
+    {
+        table[key] = key;
+    }
+
+    {
+        std::shared_mutex mutex;
+        run("std::shared_mutex",
+            [&](size_t key) { std::shared_lock lock(mutex); return table.find(key)->second; },
+            [&](size_t key) { std::unique_lock lock(mutex); table[key]++; });
+    }
+
+    {
+        ReaderWriterLock rwLock;
+        run("ReaderWriterLock",
+            [&](size_t key) { std::shared_lock lock(rwLock); return table.find(key)->second; },
+            [&](size_t key) { std::unique_lock lock(rwLock); table[key]++; });
+    }
+
+    {
+        // values are updated in place, so striping by key is enough here
+        ShardedReaderWriterLock<16> shardedLock;
+        run("ShardedReaderWriterLock<16>",
+            [&](size_t key) { std::shared_lock lock(shardedLock.GetShard(key)); return table.find(key)->second; },
+            [&](size_t key) { std::unique_lock lock(shardedLock.GetShard(key)); table.find(key)->second++; });
+    }
+}
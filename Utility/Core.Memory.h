@@ -1,6 +1,9 @@
 #pragma once
 #include "Core.Definition.h"
 #include "MemoryPool.h"
+#include "InplaceFunction.h"
+#include "SmallVector.h"
+#include "DeferredDestruction.h"
 #include <concepts>
 
 template<typename T>
@@ -22,27 +25,35 @@ namespace Memory
     //޸  : IUnknown ӹ Ŭ  Release() ȣ ->   delete ȣ
     void SafeDelete(Pointer auto& ptr)
     {
-		if constexpr (std::is_pointer_v<decltype(ptr)>)
-		{
-			if constexpr (std::derived_from<decltype(ptr), IUnknown>)
-			{
-				ptr->Release();
-			}
-			else if constexpr (requires T::is_segmented_pointer)
-			{
-                if (ptr.get())
-                {
-					ptr->~T();
-					ptr.getPool()->deallocate(ptr.get());
-					ptr.reset();
-                }
-			}
-			else
-			{
-				delete ptr;
-				ptr = nullptr;
-			}
-		}
+        using PointerType = std::remove_reference_t<decltype(ptr)>;
+
+        if constexpr (requires { typename PointerType::is_segmented_pointer; })
+        {
+            using Element = std::remove_reference_t<decltype(*ptr.get())>;
+            if (ptr.get())
+            {
+                ptr.get()->~Element();
+                ptr.getPool()->deallocate(ptr.get(), sizeof(Element), alignof(Element));
+                ptr.reset();
+            }
+        }
+        else if constexpr (std::is_pointer_v<PointerType>)
+        {
+            if (!ptr)
+            {
+                return;
+            }
+
+            if constexpr (std::derived_from<std::remove_cv_t<std::remove_pointer_t<PointerType>>, IUnknown>)
+            {
+                ptr->Release();
+            }
+            else
+            {
+                delete ptr;
+            }
+            ptr = nullptr;
+        }
     }
 }
 //  : ̳ʿ  ()   ϴ Ŭ -> function ü Ͽ     
@@ -50,21 +61,23 @@ template<typename T, typename Container>
 class DeferredDeleter final
 {
 public:
-    using Func = std::function<bool(T*)>;
+    using Func = InplaceFunction<bool(T*)>;
 public:
     DeferredDeleter() = default;
     DeferredDeleter(Container* container, Func func = [](T* ptr) { return true; }) : _container(container), m_deleteElementFunc(func) {}
+    // selected elements go to the global deferred destruction queue and leave the container
     ~DeferredDeleter()
     {
         for (auto& ptr : *_container)
         {
             if (m_deleteElementFunc(ptr))
             {
-                Memory::SafeDelete(ptr);
+                DeferredDestructionQueue::GetGlobal().Retire(ptr);
+                ptr = nullptr;
             }
         }
 
-        std::erase_if(*_container, [](T* ptr) { return ptr == nullptr; });
+        _container->erase(std::remove(_container->begin(), _container->end(), nullptr), _container->end());
     }
 
     void operator()(Container* container)
@@ -83,6 +96,12 @@ DeferredDeleter(std::vector<T*, Allocator>*, auto) -> DeferredDeleter<T, std::ve
 template<typename T, typename Allocator>
 DeferredDeleter(std::vector<T*, Allocator>*) -> DeferredDeleter<T, std::vector<T*, Allocator>>;
 
+template<typename T, size_t N>
+DeferredDeleter(SmallVector<T*, N>*, auto) -> DeferredDeleter<T, SmallVector<T*, N>>;
+
+template<typename T, size_t N>
+DeferredDeleter(SmallVector<T*, N>*) -> DeferredDeleter<T, SmallVector<T*, N>>;
+
 template <typename T>
 class SegmentedPointer
 {
@@ -91,7 +110,7 @@ private:
     void* rawPointer;
 
 public:
-	using is_segment_pointer = std::true_type;
+	using is_segmented_pointer = std::true_type;
 
 public:
     SegmentedPointer() : pool(nullptr), rawPointer(nullptr) {}
@@ -100,7 +119,7 @@ public:
     SegmentedPointer(MemoryPool* pool, Args&&... args)
         : pool(pool)
     {
-        rawPointer = pool->allocate(sizeof(T));
+        rawPointer = pool->allocate(sizeof(T), alignof(T));
         new (rawPointer) T(std::forward<Args>(args)...); // Placement New
     }
 
@@ -119,7 +138,7 @@ public:
             if (rawPointer)
             {
                 static_cast<T*>(rawPointer)->~T();
-                pool->deallocate(rawPointer);
+                pool->deallocate(rawPointer, sizeof(T), alignof(T));
             }
 
             pool = other.pool;
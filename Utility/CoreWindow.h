@@ -1,8 +1,9 @@
 #pragma once
 #include <windows.h>
-#include <functional>
 #include <unordered_map>
 #include "DumpHandler.h"
+#include "InplaceFunction.h"
+#include "FrameListener.h"
 
 #include "imgui.h"
 #include "imgui_impl_win32.h"
@@ -16,7 +17,8 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 class CoreWindow
 {
 public:
-    using MessageHandler = std::function<LRESULT(HWND, WPARAM, LPARAM)>;
+    // instance pointer + member function pointer always fit inline, so registering never allocates
+    using MessageHandler = InplaceFunction<LRESULT(HWND, WPARAM, LPARAM), 32>;
 
     CoreWindow(HINSTANCE hInstance, const wchar_t* title, int width, int height)
         : m_hInstance(hInstance), m_width(width), m_height(height)
@@ -73,6 +75,7 @@ public:
             }
             else
             {
+                FrameListenerRegistry::GetGlobal().BeginFrame();
                 fn_messageLoop();
             }
         }
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_PAUSE() _mm_pause()
+#elif defined(_M_ARM64) || defined(_M_ARM)
+#include <intrin.h>
+#define CPU_PAUSE() __yield()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define CPU_PAUSE() std::this_thread::yield()
+#endif
+
+// Spin-wait hint for the current core (pause on x86, yield on ARM)
+inline void CpuPause()
+{
+    CPU_PAUSE();
+}
+
+// --------------------------------------------------------
+// Exponential backoff for spin loops: pauses 1, 2, 4 ...
+// times up to a cap, then starts yielding the time slice
+// --------------------------------------------------------
+class Backoff
+{
+public:
+    static constexpr uint32_t SPIN_LIMIT = 64;
+
+    void Pause()
+    {
+        if (spins <= SPIN_LIMIT)
+        {
+            for (uint32_t i = 0; i < spins; ++i)
+            {
+                CpuPause();
+            }
+            spins <<= 1;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    bool IsSpinning() const { return spins <= SPIN_LIMIT; }
+    void Reset() { spins = 1; }
+
+private:
+    uint32_t spins{ 1 };
+};
@@ -0,0 +1,122 @@
+#include "DeferredDestruction.h"
+#include <mutex>
+
+DeferredDestructionQueue::DeferredDestructionQueue(uint32_t frameLatency)
+    : frameLatency(frameLatency)
+{
+}
+
+DeferredDestructionQueue::~DeferredDestructionQueue()
+{
+    Flush();
+}
+
+void DeferredDestructionQueue::Retire(void* object, DestroyBatchFunc destroy, void* context)
+{
+    std::lock_guard lock(queueLock);
+
+    if (frames.empty() || frames.back().frameIndex != currentFrame)
+    {
+        frames.push_back({ currentFrame, {} });
+    }
+
+    // a frame only ever holds a handful of object types, a linear scan beats a map here
+    std::vector<Batch>& batches = frames.back().batches;
+    for (Batch& batch : batches)
+    {
+        if (batch.destroy == destroy && batch.context == context)
+        {
+            batch.objects.push_back(object);
+            return;
+        }
+    }
+
+    batches.push_back({ destroy, context, { object } });
+}
+
+void DeferredDestructionQueue::OnFrameBegin(uint64_t frameIndex)
+{
+    Collect(frameIndex);
+}
+
+// --------------------------------------------------------
+// Destroys everything retired frameLatency or more frames
+// before frameIndex; frameIndex becomes the retire frame
+// for subsequent Retire calls
+// --------------------------------------------------------
+void DeferredDestructionQueue::Collect(uint64_t frameIndex)
+{
+    std::vector<Frame> expired;
+    {
+        std::lock_guard lock(queueLock);
+        currentFrame = frameIndex;
+
+        auto it = frames.begin();
+        while (it != frames.end() && it->frameIndex + frameLatency <= frameIndex)
+        {
+            ++it;
+        }
+        expired.assign(std::make_move_iterator(frames.begin()), std::make_move_iterator(it));
+        frames.erase(frames.begin(), it);
+    }
+
+    // destructors run outside the lock so they may retire further objects
+    DestroyFrames(expired);
+}
+
+// --------------------------------------------------------
+// Destroys everything pending, including objects retired by
+// the destructors it runs
+// --------------------------------------------------------
+void DeferredDestructionQueue::Flush()
+{
+    while (true)
+    {
+        std::vector<Frame> all;
+        {
+            std::lock_guard lock(queueLock);
+            if (frames.empty())
+            {
+                return;
+            }
+            all.swap(frames);
+        }
+
+        DestroyFrames(all);
+    }
+}
+
+size_t DeferredDestructionQueue::GetPendingCount() const
+{
+    std::lock_guard lock(queueLock);
+
+    size_t count = 0;
+    for (const Frame& frame : frames)
+    {
+        for (const Batch& batch : frame.batches)
+        {
+            count += batch.objects.size();
+        }
+    }
+    return count;
+}
+
+// Collected by the global frame registry. The registry is created first so it outlives the queue.
+DeferredDestructionQueue& DeferredDestructionQueue::GetGlobal()
+{
+    static FrameListenerRegistry& registry = FrameListenerRegistry::GetGlobal();
+    static DeferredDestructionQueue queue;
+    [[maybe_unused]] static bool registered = (registry.Add(&queue), true);
+    return queue;
+}
+
+void DeferredDestructionQueue::DestroyFrames(std::vector<Frame>& frames)
+{
+    for (Frame& frame : frames)
+    {
+        for (Batch& batch : frame.batches)
+        {
+            batch.destroy(batch.objects.data(), batch.objects.size(), batch.context);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "FrameListener.h"
+#include "AdaptiveLock.h"
+#include "MemoryPool.h"
+#include "ObjectPool.h"
+#include <vector>
+
+// --------------------------------------------------------
+// Engine-wide retire queue. Objects retired during frame F
+// are destroyed at the start of frame F + frameLatency, when
+// the GPU can no longer be reading them. Retired objects are
+// grouped into batches by destroy function (one per type and
+// pool), so collection is a tight loop per batch rather than
+// a std::function call per element.
+// Retire may be called from any thread. The global queue
+// is collected by FrameListenerRegistry::GetGlobal().
+// --------------------------------------------------------
+class DeferredDestructionQueue : public IFrameListener
+{
+public:
+    static constexpr uint32_t DEFAULT_FRAME_LATENCY = 3;
+
+    using DestroyBatchFunc = void(*)(void* const* objects, size_t count, void* context);
+
+private:
+    struct Batch
+    {
+        DestroyBatchFunc destroy{};
+        void* context{};
+        std::vector<void*> objects;
+    };
+
+    struct Frame
+    {
+        uint64_t frameIndex{};
+        std::vector<Batch> batches;
+    };
+
+public:
+    explicit DeferredDestructionQueue(uint32_t frameLatency = DEFAULT_FRAME_LATENCY);
+    ~DeferredDestructionQueue();
+
+    DeferredDestructionQueue(const DeferredDestructionQueue&) = delete;
+    DeferredDestructionQueue& operator=(const DeferredDestructionQueue&) = delete;
+
+    // Objects allocated with new, or COM objects (anything with Release())
+    template <typename T>
+    void Retire(T* object)
+    {
+        if (object)
+        {
+            Retire(object, &DestroyHeapBatch<T>, nullptr);
+        }
+    }
+
+    // Objects placement-constructed in a MemoryPool (make_segmented)
+    template <typename T>
+    void RetirePooled(MemoryPool* pool, T* object)
+    {
+        if (object)
+        {
+            Retire(object, &DestroyPooledBatch<T>, pool);
+        }
+    }
+
+    template <typename T>
+    void Retire(ObjectPool<T>& pool, Handle<T> handle)
+    {
+        if (handle)
+        {
+            Retire(reinterpret_cast<void*>(static_cast<uintptr_t>(handle.GetValue())), &DestroyHandleBatch<T>, &pool);
+        }
+    }
+
+    void Retire(void* object, DestroyBatchFunc destroy, void* context);
+
+    void OnFrameBegin(uint64_t frameIndex) override;
+    void Collect(uint64_t frameIndex);
+    void Flush();
+
+    size_t GetPendingCount() const;
+
+    static DeferredDestructionQueue& GetGlobal();
+
+private:
+    void DestroyFrames(std::vector<Frame>& frames);
+
+    template <typename T>
+    static void DestroyHeapBatch(void* const* objects, size_t count, void*)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            T* object = static_cast<T*>(objects[i]);
+            if constexpr (requires { object->Release(); })
+            {
+                object->Release();
+            }
+            else
+            {
+                delete object;
+            }
+        }
+    }
+
+    template <typename T>
+    static void DestroyPooledBatch(void* const* objects, size_t count, void* context)
+    {
+        MemoryPool* pool = static_cast<MemoryPool*>(context);
+        for (size_t i = 0; i < count; ++i)
+        {
+            static_cast<T*>(objects[i])->~T();
+            pool->deallocate(objects[i], sizeof(T), alignof(T));
+        }
+    }
+
+    template <typename T>
+    static void DestroyHandleBatch(void* const* objects, size_t count, void* context)
+    {
+        ObjectPool<T>* pool = static_cast<ObjectPool<T>*>(context);
+        for (size_t i = 0; i < count; ++i)
+        {
+            pool->Destroy(Handle<T>::FromValue(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(objects[i]))));
+        }
+    }
+
+private:
+    uint32_t frameLatency;
+    uint64_t currentFrame{};
+    mutable AdaptiveLock queueLock;
+    std::vector<Frame> frames; // oldest first
+};
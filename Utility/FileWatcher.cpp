@@ -0,0 +1,189 @@
+#include "FileWatcher.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+
+struct FileWatcher::State
+{
+    struct Directory
+    {
+        fs::path path;
+        HANDLE handle{ INVALID_HANDLE_VALUE };
+        OVERLAPPED overlapped{};
+        alignas(DWORD) BYTE buffer[16 * 1024];
+    };
+
+    std::vector<std::unique_ptr<Directory>> directories;
+
+    // Starts the next overlapped read; Poll checks it without waiting
+    static bool ReadChanges(Directory& directory)
+    {
+        return ReadDirectoryChangesW(directory.handle, directory.buffer, sizeof(directory.buffer), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &directory.overlapped, nullptr) != FALSE;
+    }
+};
+
+FileWatcher::FileWatcher() : state(std::make_unique<State>()) {}
+
+FileWatcher::~FileWatcher()
+{
+    for (auto& directory : state->directories)
+    {
+        DWORD bytes{};
+        CancelIoEx(directory->handle, &directory->overlapped);
+        // the buffer must outlive the cancelled read
+        GetOverlappedResult(directory->handle, &directory->overlapped, &bytes, TRUE);
+        CloseHandle(directory->overlapped.hEvent);
+        CloseHandle(directory->handle);
+    }
+}
+
+bool FileWatcher::AddDirectory(const fs::path& directory)
+{
+    std::error_code error;
+    fs::path path = fs::absolute(directory, error).lexically_normal();
+    if (error) return false;
+
+    for (auto& watched : state->directories)
+    {
+        if (watched->path == path) return true;
+    }
+
+    auto watched = std::make_unique<State::Directory>();
+    watched->path = path;
+    watched->handle = CreateFileW(path.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (watched->handle == INVALID_HANDLE_VALUE) return false;
+
+    watched->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!watched->overlapped.hEvent || !State::ReadChanges(*watched))
+    {
+        if (watched->overlapped.hEvent) CloseHandle(watched->overlapped.hEvent);
+        CloseHandle(watched->handle);
+        return false;
+    }
+
+    state->directories.push_back(std::move(watched));
+    return true;
+}
+
+std::vector<fs::path> FileWatcher::Poll()
+{
+    std::vector<fs::path> changed;
+    for (auto& directory : state->directories)
+    {
+        DWORD bytes{};
+        if (!GetOverlappedResult(directory->handle, &directory->overlapped, &bytes, FALSE))
+        {
+            // ERROR_IO_INCOMPLETE, nothing happened yet
+            continue;
+        }
+
+        // 0 bytes means the buffer overflowed and the changes were lost
+        const BYTE* entry = directory->buffer;
+        while (bytes > 0)
+        {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(entry);
+            if (info->Action == FILE_ACTION_ADDED ||
+                info->Action == FILE_ACTION_MODIFIED ||
+                info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+            {
+                changed.push_back(directory->path / std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+            }
+
+            if (info->NextEntryOffset == 0) break;
+            entry += info->NextEntryOffset;
+        }
+
+        ResetEvent(directory->overlapped.hEvent);
+        State::ReadChanges(*directory);
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+#else
+
+struct FileWatcher::State
+{
+    int descriptor{ -1 };
+    // watch descriptor -> directory
+    std::unordered_map<int, fs::path> directories;
+};
+
+FileWatcher::FileWatcher() : state(std::make_unique<State>())
+{
+    state->descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (state->descriptor >= 0)
+    {
+        close(state->descriptor);
+    }
+}
+
+bool FileWatcher::AddDirectory(const fs::path& directory)
+{
+    if (state->descriptor < 0) return false;
+
+    std::error_code error;
+    fs::path path = fs::absolute(directory, error).lexically_normal();
+    if (error) return false;
+
+    // Writers that replace the file (rename over it) show up as IN_MOVED_TO
+    int watch = inotify_add_watch(state->descriptor, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0) return false;
+
+    state->directories[watch] = path;
+    return true;
+}
+
+std::vector<fs::path> FileWatcher::Poll()
+{
+    std::vector<fs::path> changed;
+    if (state->descriptor < 0) return changed;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true)
+    {
+        ssize_t bytes = read(state->descriptor, buffer, sizeof(buffer));
+        if (bytes <= 0)
+        {
+            // EAGAIN, nothing left to read
+            break;
+        }
+
+        for (char* entry = buffer; entry < buffer + bytes;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(entry);
+            entry += sizeof(inotify_event) + event->len;
+
+            auto directory = state->directories.find(event->wd);
+            if (event->len == 0 || directory == state->directories.end()) continue;
+
+            changed.push_back(directory->second / event->name);
+        }
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+// --------------------------------------------------------
+// Reports files created, written or renamed into a set of
+// directories (not their subdirectories). Built on
+// ReadDirectoryChangesW on Windows and inotify on Linux.
+// Nothing runs in the background: Poll collects what
+// happened since the last call without blocking, so it can
+// be called once a frame.
+// --------------------------------------------------------
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Returns false if the directory can't be watched; adding one twice is fine
+    bool AddDirectory(const std::filesystem::path& directory);
+
+    // Changed files, each reported once, as directory / file name.
+    // Windows reports writes as they happen, so a file may still be
+    // open for writing when it shows up here.
+    std::vector<std::filesystem::path> Poll();
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
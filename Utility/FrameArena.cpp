@@ -0,0 +1,108 @@
+#include "FrameArena.h"
+#include "SpinLock.h"
+#include <algorithm>
+#include <stdexcept>
+
+FrameArena::FrameArena(size_t frameCapacity, uint32_t bufferCount)
+    : frameCapacity(frameCapacity), bufferCount(bufferCount), buffers(std::make_unique<FrameBuffer[]>(bufferCount))
+{
+    if (bufferCount == 0)
+    {
+        throw std::invalid_argument("FrameArena needs at least one buffer.");
+    }
+
+    for (uint32_t i = 0; i < bufferCount; ++i)
+    {
+        buffers[i].memory = static_cast<char*>(AlignedMalloc(frameCapacity, CACHE_LINE_SIZE));
+        if (!buffers[i].memory)
+        {
+            // the destructor won't run, so the buffers made so far are freed here
+            for (uint32_t j = 0; j < i; ++j)
+            {
+                AlignedFree(buffers[j].memory);
+            }
+            throw std::bad_alloc();
+        }
+    }
+}
+
+FrameArena::~FrameArena()
+{
+    for (uint32_t i = 0; i < bufferCount; ++i)
+    {
+        ReleaseOverflow(buffers[i]);
+        AlignedFree(buffers[i].memory);
+    }
+}
+
+// --------------------------------------------------------
+// Moves to the oldest buffer and resets it. Must not race
+// with Allocate; call it from the frame loop only.
+// --------------------------------------------------------
+void FrameArena::BeginFrame()
+{
+    FrameBuffer& previous = buffers[currentBuffer];
+    previous.peak = std::max(previous.peak, previous.offset.load(std::memory_order_relaxed));
+
+    currentBuffer = (currentBuffer + 1) % bufferCount;
+
+    FrameBuffer& next = buffers[currentBuffer];
+    ReleaseOverflow(next);
+    next.offset.store(0, std::memory_order_relaxed);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    FrameBuffer& buffer = buffers[currentBuffer];
+    uintptr_t base = reinterpret_cast<uintptr_t>(buffer.memory);
+
+    size_t offset = buffer.offset.load(std::memory_order_relaxed);
+    size_t alignedOffset;
+    do
+    {
+        alignedOffset = AlignUp(base + offset, alignment) - base;
+        if (alignedOffset + size > frameCapacity)
+        {
+            return AllocateOverflow(buffer, size, alignment);
+        }
+    } while (!buffer.offset.compare_exchange_weak(offset, alignedOffset + size, std::memory_order_relaxed));
+
+    return buffer.memory + alignedOffset;
+}
+
+size_t FrameArena::GetUsedBytes() const
+{
+    return buffers[currentBuffer].offset.load(std::memory_order_relaxed);
+}
+
+size_t FrameArena::GetPeakBytes() const
+{
+    size_t peak = GetUsedBytes();
+    for (uint32_t i = 0; i < bufferCount; ++i)
+    {
+        peak = std::max(peak, buffers[i].peak);
+    }
+    return peak;
+}
+
+void* FrameArena::AllocateOverflow(FrameBuffer& buffer, size_t size, size_t alignment)
+{
+    void* memory = AlignedMalloc(size, std::max(alignment, DEFAULT_ALIGNMENT));
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+
+    SpinLock lock(buffer.overflowLock);
+    buffer.overflow.push_back(memory);
+    return memory;
+}
+
+void FrameArena::ReleaseOverflow(FrameBuffer& buffer)
+{
+    for (void* memory : buffer.overflow)
+    {
+        AlignedFree(memory);
+    }
+    buffer.overflow.clear();
+}
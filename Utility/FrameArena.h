@@ -0,0 +1,93 @@
+#pragma once
+#include "FrameListener.h"
+#include "MemoryAlignment.h"
+#include <atomic>
+#include <vector>
+#include <memory>
+
+// --------------------------------------------------------
+// Linear allocator for data that only lives for a frame.
+// Allocation is a bump of an atomic offset; nothing is freed
+// individually. Memory is recycled bufferCount frames later,
+// so data handed to the GPU stays valid while in flight.
+// --------------------------------------------------------
+class FrameArena : public IFrameListener
+{
+public:
+    static constexpr uint32_t DEFAULT_BUFFER_COUNT = 3;
+
+private:
+    struct FrameBuffer
+    {
+        char* memory{};
+        std::atomic<size_t> offset{};
+        size_t peak{};
+        std::atomic_flag overflowLock{};
+        std::vector<void*> overflow; // requests that did not fit, freed when the buffer is reused
+    };
+
+public:
+    explicit FrameArena(size_t frameCapacity, uint32_t bufferCount = DEFAULT_BUFFER_COUNT);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void BeginFrame();
+    void OnFrameBegin(uint64_t) override { BeginFrame(); }
+
+    void* Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    size_t GetCapacity() const { return frameCapacity; }
+    size_t GetUsedBytes() const;
+    size_t GetPeakBytes() const;
+    uint32_t GetBufferCount() const { return bufferCount; }
+
+private:
+    void* AllocateOverflow(FrameBuffer& buffer, size_t size, size_t alignment);
+    void ReleaseOverflow(FrameBuffer& buffer);
+
+private:
+    size_t frameCapacity;
+    uint32_t bufferCount;
+    uint32_t currentBuffer{};
+    std::unique_ptr<FrameBuffer[]> buffers;
+};
+
+// STL allocator backed by a FrameArena. deallocate is a no-op,
+// containers built on it must not outlive the arena's frame window.
+template <typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    FrameAllocator(FrameArena* arena) noexcept : arena(arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) noexcept : arena(other.GetArena()) {}
+
+    T* allocate(size_t count)
+    {
+        return arena->AllocateArray<T>(count);
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    FrameArena* GetArena() const noexcept { return arena; }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const noexcept { return arena == other.GetArena(); }
+
+private:
+    FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,39 @@
+#include "FrameListener.h"
+#include <algorithm>
+#include <mutex>
+
+void FrameListenerRegistry::Add(IFrameListener* listener)
+{
+    std::lock_guard lock(registryLock);
+    listeners.push_back(listener);
+}
+
+void FrameListenerRegistry::Remove(IFrameListener* listener)
+{
+    std::lock_guard lock(registryLock);
+    std::erase(listeners, listener);
+}
+
+uint64_t FrameListenerRegistry::BeginFrame()
+{
+    // listeners run on a copy, so they may register others (lazily created globals) meanwhile
+    std::vector<IFrameListener*> current;
+    uint64_t index{};
+    {
+        std::lock_guard lock(registryLock);
+        current = listeners;
+        index = frameIndex++;
+    }
+
+    for (IFrameListener* listener : current)
+    {
+        listener->OnFrameBegin(index);
+    }
+    return index;
+}
+
+FrameListenerRegistry& FrameListenerRegistry::GetGlobal()
+{
+    static FrameListenerRegistry registry;
+    return registry;
+}
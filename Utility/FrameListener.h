@@ -0,0 +1,39 @@
+#pragma once
+#include "AdaptiveLock.h"
+#include <cstdint>
+#include <vector>
+
+// Implemented by systems that recycle per-frame state. A FrameListenerRegistry
+// notifies every listener it holds once at the start of each frame.
+class IFrameListener
+{
+public:
+    virtual ~IFrameListener() = default;
+    virtual void OnFrameBegin(uint64_t frameIndex) = 0;
+};
+
+// --------------------------------------------------------
+// The frame boundary. The global registry, driven by
+// CoreWindow's message loop once per frame, is the only
+// one the engine runs: frame arenas, ring allocators and
+// engine-wide services such as the deferred destruction
+// queue register there. Add may be called from any thread
+// and from OnFrameBegin; Remove belongs on the loop's
+// thread.
+// --------------------------------------------------------
+class FrameListenerRegistry
+{
+public:
+    void Add(IFrameListener* listener);
+    void Remove(IFrameListener* listener);
+
+    // Notifies every listener and returns the index of the frame that began
+    uint64_t BeginFrame();
+
+    static FrameListenerRegistry& GetGlobal();
+
+private:
+    AdaptiveLock registryLock;
+    std::vector<IFrameListener*> listeners;
+    uint64_t frameIndex{};
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Embedded in elements that an IndexedList links; one hook per list an element can be in
+struct IndexedListHook
+{
+    uint32_t prev{ UINT32_MAX };
+    uint32_t next{ UINT32_MAX };
+    bool linked{};
+};
+
+// --------------------------------------------------------
+// Intrusive index-based list over a pooled array: elements
+// stay in the caller's array and embed an IndexedListHook,
+// whose prev/next are 32-bit indices into that array rather
+// than pointers. The list never copies, owns or destroys an
+// element. Keeps LinkedList's O(1) Link/Unlink and insertion
+// order without a vtable or heap node per element.
+// The array must outlive the list and must not move while
+// anything is linked.
+//
+//   struct Item { IndexedListHook active; ... };
+//   std::vector<Item> items(count);
+//   IndexedList<Item, &Item::active> list(items.data());
+//   list.Link(index);
+// --------------------------------------------------------
+template <typename T, IndexedListHook T::*Hook>
+class IndexedList
+{
+public:
+    using Index = uint32_t;
+    static constexpr Index INVALID_INDEX = UINT32_MAX;
+
+public:
+    class Iterator
+    {
+    public:
+        Iterator(T* elements, Index index) : _elements(elements), _index(index) {}
+
+        Iterator& operator++()
+        {
+            _index = (_elements[_index].*Hook).next;
+            return *this;
+        }
+
+        T& operator*() const { return _elements[_index]; }
+        T* operator->() const { return &_elements[_index]; }
+        bool operator!=(const Iterator& other) const { return _index != other._index; }
+
+        Index GetIndex() const { return _index; }
+
+    private:
+        T* _elements{};
+        Index _index{ INVALID_INDEX };
+    };
+
+public:
+    explicit IndexedList(T* elements) : _elements(elements) {}
+    ~IndexedList() { ClearLink(); }
+
+    IndexedList(const IndexedList&) = delete;
+    IndexedList& operator=(const IndexedList&) = delete;
+
+    Iterator begin() { return Iterator(_elements, _head); }
+    Iterator end() { return Iterator(_elements, INVALID_INDEX); }
+
+    // Appends elements[index]; does nothing if it is already linked
+    void Link(Index index)
+    {
+        IndexedListHook& hook = HookAt(index);
+        if (hook.linked)
+        {
+            return;
+        }
+
+        hook.linked = true;
+        hook.prev = _tail;
+        hook.next = INVALID_INDEX;
+
+        if (_tail != INVALID_INDEX)
+        {
+            HookAt(_tail).next = index;
+        }
+        else
+        {
+            _head = index;
+        }
+        _tail = index;
+
+        ++_size;
+    }
+
+    void Unlink(Index index)
+    {
+        IndexedListHook& hook = HookAt(index);
+        if (!hook.linked)
+        {
+            return;
+        }
+
+        (hook.prev != INVALID_INDEX ? HookAt(hook.prev).next : _head) = hook.next;
+        (hook.next != INVALID_INDEX ? HookAt(hook.next).prev : _tail) = hook.prev;
+
+        hook = IndexedListHook{};
+        --_size;
+    }
+
+    bool IsLinked(Index index) const { return (_elements[index].*Hook).linked; }
+
+    T& Get(Index index) { return _elements[index]; }
+
+    template <typename Func>
+    void ForEach(Func&& func)
+    {
+        for (Index index = _head; index != INVALID_INDEX; index = HookAt(index).next)
+        {
+            func(_elements[index]);
+        }
+    }
+
+    // Unlinks everything; the elements are left alone
+    void ClearLink()
+    {
+        Index index = _head;
+        while (index != INVALID_INDEX)
+        {
+            Index next = HookAt(index).next;
+            HookAt(index) = IndexedListHook{};
+            index = next;
+        }
+
+        _head = _tail = INVALID_INDEX;
+        _size = 0;
+    }
+
+    size_t Size() const { return _size; }
+    bool Empty() const { return _size == 0; }
+
+private:
+    IndexedListHook& HookAt(Index index) { return _elements[index].*Hook; }
+
+private:
+    T* _elements{};
+    Index _head{ INVALID_INDEX };
+    Index _tail{ INVALID_INDEX };
+    size_t _size{};
+};
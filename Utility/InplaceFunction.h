@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 32>
+class InplaceFunction;
+
+// --------------------------------------------------------
+// std::function replacement that stores the callable inline
+// and never allocates. Callables larger than Capacity fail to
+// compile instead of silently going to the heap.
+// --------------------------------------------------------
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+private:
+    enum class Operation { Copy, Move, Destroy };
+
+    using Invoker = R(*)(void* storage, Args&&... args);
+    using Manager = void(*)(Operation operation, void* destination, void* source);
+
+    template <typename Callable>
+    static R Invoke(void* storage, Args&&... args)
+    {
+        return (*static_cast<Callable*>(storage))(std::forward<Args>(args)...);
+    }
+
+    template <typename Callable>
+    static void Manage(Operation operation, void* destination, void* source)
+    {
+        switch (operation)
+        {
+        case Operation::Copy:
+            new (destination) Callable(*static_cast<const Callable*>(source));
+            break;
+        case Operation::Move:
+            new (destination) Callable(std::move(*static_cast<Callable*>(source)));
+            break;
+        case Operation::Destroy:
+            static_cast<Callable*>(destination)->~Callable();
+            break;
+        }
+    }
+
+public:
+    InplaceFunction() = default;
+    InplaceFunction(std::nullptr_t) {}
+
+    template <typename Func, typename Callable = std::decay_t<Func>>
+        requires (!std::is_same_v<Callable, InplaceFunction> && std::is_invocable_r_v<R, Callable&, Args...>)
+    InplaceFunction(Func&& func)
+    {
+        static_assert(sizeof(Callable) <= Capacity, "callable does not fit in InplaceFunction, raise Capacity");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "callable is over-aligned for InplaceFunction");
+
+        new (_storage) Callable(std::forward<Func>(func));
+        _invoker = &Invoke<Callable>;
+        _manager = &Manage<Callable>;
+    }
+
+    InplaceFunction(const InplaceFunction& other)
+    {
+        if (other._manager)
+        {
+            other._manager(Operation::Copy, _storage, const_cast<std::byte*>(other._storage));
+            _invoker = other._invoker;
+            _manager = other._manager;
+        }
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept
+    {
+        MoveFrom(other);
+    }
+
+    ~InplaceFunction()
+    {
+        Reset();
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& other)
+    {
+        if (this != &other)
+        {
+            InplaceFunction copy(other);
+            Reset();
+            MoveFrom(copy);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t)
+    {
+        Reset();
+        return *this;
+    }
+
+    R operator()(Args... args) const
+    {
+        return _invoker(const_cast<std::byte*>(_storage), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return _invoker != nullptr; }
+
+private:
+    void Reset()
+    {
+        if (_manager)
+        {
+            _manager(Operation::Destroy, _storage, nullptr);
+            _invoker = nullptr;
+            _manager = nullptr;
+        }
+    }
+
+    void MoveFrom(InplaceFunction& other)
+    {
+        if (other._manager)
+        {
+            other._manager(Operation::Move, _storage, other._storage);
+            _invoker = other._invoker;
+            _manager = other._manager;
+            other.Reset();
+        }
+    }
+
+private:
+    alignas(std::max_align_t) std::byte _storage[Capacity];
+    Invoker _invoker{};
+    Manager _manager{};
+};
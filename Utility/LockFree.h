@@ -0,0 +1,217 @@
+#pragma once
+#include "CpuPause.h"
+#include "MemoryAlignment.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+// --------------------------------------------------------
+// Treiber stack for free lists. Nodes are the free blocks
+// themselves: the first pointer-sized word of a pushed
+// block is overwritten with the link, so blocks must be at
+// least sizeof(void*) and stay mapped while the list lives.
+// The head packs a 48-bit pointer with a 16-bit tag that is
+// bumped on every push/pop to defeat ABA.
+// --------------------------------------------------------
+class LockFreeFreeList
+{
+    static_assert(sizeof(void*) == 8, "LockFreeFreeList packs pointers into 48 bits");
+
+private:
+    static constexpr uint64_t POINTER_MASK = (uint64_t(1) << 48) - 1;
+
+    struct Node
+    {
+        Node* next;
+    };
+
+public:
+    void Push(void* block)
+    {
+        Node* node = static_cast<Node*>(block);
+        uint64_t oldHead = head.load(std::memory_order_relaxed);
+        do
+        {
+            node->next = Unpack(oldHead);
+        } while (!head.compare_exchange_weak(oldHead, Pack(node, oldHead), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Links the blocks together first and publishes them with a single CAS
+    void PushRange(void* const* blocks, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i + 1 < count; ++i)
+        {
+            static_cast<Node*>(blocks[i])->next = static_cast<Node*>(blocks[i + 1]);
+        }
+
+        Node* first = static_cast<Node*>(blocks[0]);
+        Node* last = static_cast<Node*>(blocks[count - 1]);
+        uint64_t oldHead = head.load(std::memory_order_relaxed);
+        do
+        {
+            last->next = Unpack(oldHead);
+        } while (!head.compare_exchange_weak(oldHead, Pack(first, oldHead), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void* Pop()
+    {
+        uint64_t oldHead = head.load(std::memory_order_acquire);
+        while (Node* node = Unpack(oldHead))
+        {
+            // node may already be popped and reused by another thread; the tag makes the CAS fail then
+            Node* next = node->next;
+            if (head.compare_exchange_weak(oldHead, Pack(next, oldHead), std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    bool Empty() const { return Unpack(head.load(std::memory_order_relaxed)) == nullptr; }
+
+private:
+    static Node* Unpack(uint64_t value)
+    {
+        return reinterpret_cast<Node*>(value & POINTER_MASK);
+    }
+
+    static uint64_t Pack(Node* node, uint64_t previous)
+    {
+        uint64_t tag = (previous >> 48) + 1;
+        return (tag << 48) | (reinterpret_cast<uint64_t>(node) & POINTER_MASK);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{};
+};
+
+// --------------------------------------------------------
+// Bounded multi-producer/multi-consumer ring queue
+// (Vyukov). Each cell carries a sequence number so that
+// producers and consumers only contend on their own index.
+// Capacity must be a power of two.
+// --------------------------------------------------------
+template <typename T>
+class MPMCQueue
+{
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+public:
+    explicit MPMCQueue(size_t capacity)
+        : capacity(capacity), mask(capacity - 1), cells(std::make_unique<Cell[]>(capacity))
+    {
+        if (!IsPowerOfTwo(capacity))
+        {
+            throw std::invalid_argument("MPMCQueue capacity must be a power of two.");
+        }
+
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    template <typename U>
+    bool TryPush(U&& value)
+    {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.data = std::forward<U>(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T& value)
+    {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+            if (difference == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(cell.data);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Blocking variants spin with backoff; only use where the other side is known to be running
+    template <typename U>
+    void Push(U&& value)
+    {
+        Backoff backoff;
+        while (!TryPush(std::forward<U>(value)))
+        {
+            backoff.Pause();
+        }
+    }
+
+    T Pop()
+    {
+        T value;
+        Backoff backoff;
+        while (!TryPop(value))
+        {
+            backoff.Pause();
+        }
+        return value;
+    }
+
+    size_t Capacity() const { return capacity; }
+
+private:
+    size_t capacity;
+    size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePosition{};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePosition{};
+};
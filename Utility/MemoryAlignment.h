@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+constexpr size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+constexpr bool IsPowerOfTwo(size_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+// alignment must be a power of two
+constexpr size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline char* AlignPointer(char* pointer, size_t alignment)
+{
+    return reinterpret_cast<char*>(AlignUp(reinterpret_cast<uintptr_t>(pointer), alignment));
+}
+
+inline void* AlignedMalloc(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, AlignUp(size, alignment));
+#endif
+}
+
+inline void AlignedFree(void* pointer)
+{
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+// Pads T out to its own cache line so hot atomics never share a line with their neighbours.
+// Use with make_segmented<CacheLineIsolated<T>> or MemoryPool::allocateIsolated.
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) CacheLineIsolated
+{
+    T value;
+
+    template <typename... Args>
+    CacheLineIsolated(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T& operator*() { return value; }
+    T* operator->() { return &value; }
+    const T& operator*() const { return value; }
+    const T* operator->() const { return &value; }
+};
@@ -0,0 +1,261 @@
+#include "MemoryBudget.h"
+#include "MemoryPool.h"
+#include "SpinLock.h"
+#include <algorithm>
+#include <fstream>
+#include <new>
+
+namespace
+{
+    // sits right before every block handed out by MemoryBudget::Allocate
+    struct AllocationHeader
+    {
+        const char* tag;
+        size_t size;
+        uint32_t offset; // from the start of the raw allocation to the user block
+        MemoryHeap heap;
+    };
+
+    // keeps the header itself aligned for any fundamental type
+    constexpr size_t HEADER_SIZE = AlignUp(sizeof(AllocationHeader), DEFAULT_ALIGNMENT);
+
+    AllocationHeader* HeaderOf(void* ptr)
+    {
+        return reinterpret_cast<AllocationHeader*>(static_cast<std::byte*>(ptr) - sizeof(AllocationHeader));
+    }
+
+    std::string_view TagOf(const char* tag)
+    {
+        return tag ? std::string_view(tag) : std::string_view("untagged");
+    }
+}
+
+const char* GetMemoryHeapName(MemoryHeap heap)
+{
+    switch (heap)
+    {
+    case MemoryHeap::General:    return "General";
+    case MemoryHeap::Mesh:       return "Mesh";
+    case MemoryHeap::Texture:    return "Texture";
+    case MemoryHeap::ShaderData: return "ShaderData";
+    case MemoryHeap::ECS:        return "ECS";
+    default:                     return "Unknown";
+    }
+}
+
+void MemoryBudget::SetBudget(MemoryHeap heap, size_t softBudget, size_t hardBudget)
+{
+    Heap& target = heaps[static_cast<size_t>(heap)];
+    target.softBudget.store(softBudget, std::memory_order_relaxed);
+    target.hardBudget.store(hardBudget, std::memory_order_relaxed);
+    target.overSoftBudget.store(false, std::memory_order_relaxed);
+}
+
+void MemoryBudget::AddSoftLimitCallback(MemoryHeap heap, SoftLimitCallback callback)
+{
+    SpinLock lock(callbackLock);
+    heaps[static_cast<size_t>(heap)].callbacks.push_back(std::move(callback));
+}
+
+void* MemoryBudget::Allocate(MemoryHeap heap, size_t size, size_t alignment)
+{
+    if (!IsPowerOfTwo(alignment))
+    {
+        throw std::invalid_argument("alignment must be a power of two");
+    }
+
+    const char* tag = MemoryTagScope::current();
+    Charge(heap, size, TagOf(tag), true);
+
+    size_t offset = std::max(HEADER_SIZE, AlignUp(sizeof(AllocationHeader), alignment));
+    void* raw = AlignedMalloc(offset + size, std::max(alignment, DEFAULT_ALIGNMENT));
+    if (!raw)
+    {
+        Release(heap, size, TagOf(tag));
+        throw std::bad_alloc();
+    }
+
+    void* ptr = static_cast<std::byte*>(raw) + offset;
+    *HeaderOf(ptr) = { tag, size, static_cast<uint32_t>(offset), heap };
+    return ptr;
+}
+
+void MemoryBudget::Deallocate(void* ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    AllocationHeader header = *HeaderOf(ptr);
+    Release(header.heap, header.size, TagOf(header.tag));
+    AlignedFree(static_cast<std::byte*>(ptr) - header.offset);
+}
+
+// The memory already exists, so tracking can't fail: the hard budget
+// is not enforced and an exception from a soft limit callback is dropped
+void MemoryBudget::Track(MemoryHeap heap, size_t size) noexcept
+{
+    try
+    {
+        Charge(heap, size, TagOf(MemoryTagScope::current()), false);
+    }
+    catch (...)
+    {
+    }
+}
+
+void MemoryBudget::Untrack(MemoryHeap heap, size_t size) noexcept
+{
+    Release(heap, size, TagOf(MemoryTagScope::current()));
+}
+
+void MemoryBudget::Charge(MemoryHeap heap, size_t size, std::string_view tag, bool enforceHardBudget)
+{
+    Heap& target = heaps[static_cast<size_t>(heap)];
+
+    size_t hardBudget = enforceHardBudget ? target.hardBudget.load(std::memory_order_relaxed) : 0;
+    size_t used = target.used.fetch_add(size, std::memory_order_relaxed) + size;
+    if (hardBudget && used > hardBudget)
+    {
+        // give eviction one chance to make room before failing the request
+        target.used.fetch_sub(size, std::memory_order_relaxed);
+        NotifySoftLimit(heap, used);
+
+        used = target.used.fetch_add(size, std::memory_order_relaxed) + size;
+        if (used > hardBudget)
+        {
+            target.used.fetch_sub(size, std::memory_order_relaxed);
+            throw std::bad_alloc();
+        }
+    }
+
+    size_t peak = target.peak.load(std::memory_order_relaxed);
+    while (used > peak && !target.peak.compare_exchange_weak(peak, used, std::memory_order_relaxed))
+    {
+    }
+    target.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        SpinLock lock(consumerLock);
+        try
+        {
+            consumers[{ heap, tag }] += size;
+        }
+        catch (const std::bad_alloc&)
+        {
+            // only the per-tag report misses these bytes, the heap totals above are already counted
+        }
+    }
+
+    size_t softBudget = target.softBudget.load(std::memory_order_relaxed);
+    if (softBudget && used > softBudget && !target.overSoftBudget.exchange(true, std::memory_order_relaxed))
+    {
+        NotifySoftLimit(heap, used);
+    }
+}
+
+void MemoryBudget::Release(MemoryHeap heap, size_t size, std::string_view tag)
+{
+    Heap& target = heaps[static_cast<size_t>(heap)];
+    size_t used = target.used.fetch_sub(size, std::memory_order_relaxed) - size;
+
+    {
+        SpinLock lock(consumerLock);
+        auto it = consumers.find({ heap, tag });
+        if (it != consumers.end())
+        {
+            it->second -= std::min(it->second, size);
+        }
+    }
+
+    // re-arm the soft limit callbacks once usage is back under budget
+    size_t softBudget = target.softBudget.load(std::memory_order_relaxed);
+    if (softBudget && used <= softBudget)
+    {
+        target.overSoftBudget.store(false, std::memory_order_relaxed);
+    }
+}
+
+void MemoryBudget::NotifySoftLimit(MemoryHeap heap, size_t used)
+{
+    Heap& target = heaps[static_cast<size_t>(heap)];
+
+    // callbacks are copied out so they can allocate or free from this heap
+    std::vector<SoftLimitCallback> callbacks;
+    {
+        SpinLock lock(callbackLock);
+        callbacks = target.callbacks;
+    }
+
+    size_t softBudget = target.softBudget.load(std::memory_order_relaxed);
+    for (auto& callback : callbacks)
+    {
+        callback(heap, used, softBudget);
+    }
+}
+
+MemoryBudget::HeapReport MemoryBudget::GetHeapReport(MemoryHeap heap) const
+{
+    const Heap& source = heaps[static_cast<size_t>(heap)];
+
+    HeapReport report;
+    report.heap = heap;
+    report.used = source.used.load(std::memory_order_relaxed);
+    report.peak = source.peak.load(std::memory_order_relaxed);
+    report.softBudget = source.softBudget.load(std::memory_order_relaxed);
+    report.hardBudget = source.hardBudget.load(std::memory_order_relaxed);
+    report.allocations = source.allocations.load(std::memory_order_relaxed);
+    return report;
+}
+
+std::vector<MemoryBudget::Consumer> MemoryBudget::GetTopConsumers(size_t count) const
+{
+    std::vector<Consumer> result;
+    {
+        SpinLock lock(consumerLock);
+        result.reserve(consumers.size());
+        for (const auto& [key, bytes] : consumers)
+        {
+            if (bytes)
+            {
+                result.push_back({ key.heap, key.tag, bytes });
+            }
+        }
+    }
+
+    count = std::min(count, result.size());
+    std::partial_sort(result.begin(), result.begin() + count, result.end(),
+        [](const Consumer& lhs, const Consumer& rhs) { return lhs.bytes > rhs.bytes; });
+    result.resize(count);
+    return result;
+}
+
+bool MemoryBudget::DumpReport(const std::filesystem::path& path, size_t consumerCount) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "[Heaps]\n";
+    for (size_t i = 0; i < MEMORY_HEAP_COUNT; ++i)
+    {
+        HeapReport report = GetHeapReport(static_cast<MemoryHeap>(i));
+        file << GetMemoryHeapName(report.heap)
+            << " used=" << report.used
+            << " peak=" << report.peak
+            << " soft=" << report.softBudget
+            << " hard=" << report.hardBudget
+            << " allocations=" << report.allocations << "\n";
+    }
+
+    file << "\n[Top consumers]\n";
+    for (const Consumer& consumer : GetTopConsumers(consumerCount))
+    {
+        file << GetMemoryHeapName(consumer.heap) << " " << consumer.tag << " bytes=" << consumer.bytes << "\n";
+    }
+
+    return true;
+}
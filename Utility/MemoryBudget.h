@@ -0,0 +1,159 @@
+#pragma once
+#include "ClassProperty.h"
+#include "MemoryAlignment.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class MemoryHeap : uint8_t
+{
+    General,
+    Mesh,
+    Texture,
+    ShaderData,
+    ECS,
+    Count,
+};
+
+constexpr size_t MEMORY_HEAP_COUNT = static_cast<size_t>(MemoryHeap::Count);
+
+const char* GetMemoryHeapName(MemoryHeap heap);
+
+// --------------------------------------------------------
+// Routes subsystem allocations through named heaps with soft
+// and hard budgets (0 = unlimited). Crossing a soft budget
+// calls the heap's callbacks once, so streaming can evict;
+// an allocation that would cross the hard budget calls them
+// again and throws std::bad_alloc if they could not make room.
+// Allocations are attributed to the current MemoryTagScope
+// tag for the top-consumers report.
+// GPU memory that is not allocated here (buffers, textures)
+// can be accounted for with Track / Untrack.
+// --------------------------------------------------------
+class MemoryBudget : public Singleton<MemoryBudget>
+{
+private:
+    friend class Singleton;
+
+public:
+    // heap, bytes in use, soft budget
+    using SoftLimitCallback = std::function<void(MemoryHeap, size_t, size_t)>;
+
+    struct HeapReport
+    {
+        MemoryHeap heap{};
+        size_t used{};
+        size_t peak{};
+        size_t softBudget{};
+        size_t hardBudget{};
+        uint64_t allocations{};
+    };
+
+    struct Consumer
+    {
+        MemoryHeap heap{};
+        std::string_view tag;
+        size_t bytes{};
+    };
+
+private:
+    struct Heap
+    {
+        std::atomic<size_t> used{};
+        std::atomic<size_t> peak{};
+        std::atomic<uint64_t> allocations{};
+        std::atomic<size_t> softBudget{};
+        std::atomic<size_t> hardBudget{};
+        std::atomic<bool> overSoftBudget{};
+        std::vector<SoftLimitCallback> callbacks;
+    };
+
+    struct ConsumerKey
+    {
+        MemoryHeap heap;
+        std::string_view tag;
+
+        bool operator==(const ConsumerKey&) const = default;
+    };
+
+    struct ConsumerKeyHash
+    {
+        size_t operator()(const ConsumerKey& key) const
+        {
+            return std::hash<std::string_view>{}(key.tag) * 31 + static_cast<size_t>(key.heap);
+        }
+    };
+
+private:
+    MemoryBudget() = default;
+    ~MemoryBudget() = default;
+
+public:
+    void SetBudget(MemoryHeap heap, size_t softBudget, size_t hardBudget);
+    void AddSoftLimitCallback(MemoryHeap heap, SoftLimitCallback callback);
+
+    void* Allocate(MemoryHeap heap, size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+    void Deallocate(void* ptr);
+
+    // accounting only, for memory owned by the driver or another allocator;
+    // never throws and may take a heap past its hard budget
+    void Track(MemoryHeap heap, size_t size) noexcept;
+    void Untrack(MemoryHeap heap, size_t size) noexcept;
+
+    HeapReport GetHeapReport(MemoryHeap heap) const;
+    std::vector<Consumer> GetTopConsumers(size_t count) const;
+    bool DumpReport(const std::filesystem::path& path, size_t consumerCount = 16) const;
+
+private:
+    void Charge(MemoryHeap heap, size_t size, std::string_view tag, bool enforceHardBudget);
+    void Release(MemoryHeap heap, size_t size, std::string_view tag);
+    void NotifySoftLimit(MemoryHeap heap, size_t used);
+
+private:
+    std::array<Heap, MEMORY_HEAP_COUNT> heaps;
+    mutable std::atomic_flag callbackLock{};
+    mutable std::atomic_flag consumerLock{};
+    std::unordered_map<ConsumerKey, size_t, ConsumerKeyHash> consumers;
+};
+
+inline static auto& MemoryBudgets = MemoryBudget::GetInstance();
+
+// --------------------------------------------------------
+// std allocator that charges a MemoryBudget heap, for the
+// vectors and maps a subsystem owns
+// --------------------------------------------------------
+template <typename T, MemoryHeap Heap>
+class BudgetAllocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = BudgetAllocator<U, Heap>;
+    };
+
+    BudgetAllocator() = default;
+
+    template <typename U>
+    BudgetAllocator(const BudgetAllocator<U, Heap>&) {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(MemoryBudgets->Allocate(Heap, count * sizeof(T), alignof(T) > DEFAULT_ALIGNMENT ? alignof(T) : DEFAULT_ALIGNMENT));
+    }
+
+    void deallocate(T* ptr, size_t)
+    {
+        MemoryBudgets->Deallocate(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const BudgetAllocator<U, Heap>&) const { return true; }
+};
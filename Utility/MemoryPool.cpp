@@ -1,31 +1,202 @@
 #include "MemoryPool.h"
+#include "SpinLock.h"
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <fstream>
 
-MemoryPool::MemoryPool(const std::vector<size_t>& segmentSizes)
+namespace
 {
-    for (size_t size : segmentSizes)
+    std::atomic<uint64_t> s_nextPoolId{ 1 };
+    constexpr size_t MAX_GROWTH_SIZE = size_t(1) << 30;
+    thread_local const char* t_memoryTag = "untagged";
+
+    // sampled once per thread; threads that migrate between sockets keep their first node
+    int LocalNumaNode()
+    {
+        thread_local int node = VirtualMemory::GetCurrentNumaNode();
+        return node;
+    }
+
+    size_t HomeShard()
+    {
+        thread_local size_t shard = std::hash<std::thread::id>{}(std::this_thread::get_id()) % MemoryPool::DEPOT_SHARD_COUNT;
+        return shard;
+    }
+}
+
+MemoryTagScope::MemoryTagScope(const char* tag)
+    : previous(t_memoryTag)
+{
+    t_memoryTag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope()
+{
+    t_memoryTag = previous;
+}
+
+const char* MemoryTagScope::current()
+{
+    return t_memoryTag;
+}
+
+struct MemoryPool::ThreadCache
+{
+    struct Magazine
+    {
+        void* blocks[MAGAZINE_CAPACITY]{};
+        size_t count{};
+    };
+
+    uint64_t poolId{};
+    size_t shard{};
+    std::weak_ptr<Depot> depot;
+    Magazine magazines[SIZE_CLASS_COUNT]{};
+
+    // moves the oldest `count` blocks of a magazine into this thread's depot shard
+    static void flush(Depot& target, size_t shard, size_t sizeClass, Magazine& magazine, size_t count)
+    {
+        target.shards[shard].blocks[sizeClass].PushRange(magazine.blocks, count);
+        std::memmove(magazine.blocks, magazine.blocks + count, (magazine.count - count) * sizeof(void*));
+        magazine.count -= count;
+    }
+
+    ~ThreadCache()
+    {
+        // blocks cached by an exiting thread go back to the depot so other threads can reuse them
+        if (auto target = depot.lock())
+        {
+            for (size_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+            {
+                if (magazines[sizeClass].count)
+                {
+                    flush(*target, shard, sizeClass, magazines[sizeClass], magazines[sizeClass].count);
+                }
+            }
+        }
+    }
+};
+
+MemoryPool::MemoryPool(const std::vector<size_t>& segmentSizes, unsigned int flags)
+    : poolId(s_nextPoolId.fetch_add(1, std::memory_order_relaxed)), flags(flags)
+{
+    if (flags & (MEMORY_POOL_FLAG_LARGE_PAGES | MEMORY_POOL_FLAG_NUMA_LOCAL))
+    {
+        this->flags |= MEMORY_POOL_FLAG_VIRTUAL;
+    }
+
+    // segments are only reserved, so a copy per node costs address space rather than memory
+    int nodeCount = (flags & MEMORY_POOL_FLAG_NUMA_LOCAL) ? VirtualMemory::GetNumaNodeCount() : 1;
+    segments.reserve(segmentSizes.size() * nodeCount + ((this->flags & MEMORY_POOL_FLAG_VIRTUAL) ? MAX_GROWN_SEGMENTS : 0));
+    for (int node = 0; node < nodeCount; ++node)
+    {
+        VirtualMemory::Placement placement;
+        placement.largePages = flags & MEMORY_POOL_FLAG_LARGE_PAGES;
+        placement.numaNode = (flags & MEMORY_POOL_FLAG_NUMA_LOCAL) ? node : VirtualMemory::ANY_NUMA_NODE;
+
+        for (size_t size : segmentSizes)
+        {
+            SegmentBacking backing = (this->flags & MEMORY_POOL_FLAG_VIRTUAL) ? SegmentBacking::Virtual : SegmentBacking::Heap;
+            segments.push_back(std::make_unique<Segment>(size, backing, placement));
+            growthSize = std::max(growthSize, size);
+        }
+    }
+    segmentCount.store(segments.size(), std::memory_order_release);
+
+    if (flags & MEMORY_POOL_FLAG_CONCURRENT)
+    {
+        depot = std::make_shared<Depot>();
+    }
+
+    if (flags & MEMORY_POOL_FLAG_STATISTICS)
+    {
+        statistics = std::make_unique<StatisticsCounters>();
+    }
+}
+
+MemoryPool::~MemoryPool()
+{
+    if (!shutdownDumpPath.empty())
+    {
+        dumpStatistics(shutdownDumpPath);
+    }
+}
+
+void* MemoryPool::allocate(size_t size, size_t alignment)
+{
+    if (statistics)
+    {
+        recordAllocation(size);
+    }
+
+    if (isConcurrent() && isCacheable(size, alignment))
     {
-        segments.emplace_back(size);
+        return allocateCached(size, alignment);
     }
+
+    return allocateFromSegments(size, alignment);
 }
 
-void* MemoryPool::allocate(size_t size)
+// Rounds the request up to whole cache lines so nothing else can share them (hot atomics, per-thread counters)
+void* MemoryPool::allocateIsolated(size_t size)
 {
-    for (Segment& segment : segments) {
+    return allocate(AlignUp(size, CACHE_LINE_SIZE), CACHE_LINE_SIZE);
+}
+
+void* MemoryPool::allocateFromSegments(size_t size, size_t alignment)
+{
+    // local node first; remote segments below are the fallback once it is full
+    if (flags & MEMORY_POOL_FLAG_NUMA_LOCAL)
+    {
+        int node = LocalNumaNode();
+        for (auto& segment : activeSegments())
+        {
+            if (segment->getNumaNode() != node)
+            {
+                continue;
+            }
+
+            try
+            {
+                return segment->allocate(size, alignment);
+            }
+            catch (const std::bad_alloc&)
+            {
+                continue;
+            }
+        }
+    }
+
+    std::span<const std::unique_ptr<Segment>> scanned = activeSegments();
+    for (auto& segment : scanned) {
         try {
-            return segment.allocate(size);
+            return segment->allocate(size, alignment);
         }
         catch (const std::bad_alloc&) {
             continue; //  ׸Ʈ ̵
         }
     }
 
+    // every segment is full; a virtual pool reserves another one rather than moving blocks
+    if (flags & MEMORY_POOL_FLAG_VIRTUAL)
+    {
+        return grow(size, alignment, scanned.size());
+    }
+
+    // blocks held in thread caches must keep their address, so concurrent pools never compact
+    if (isConcurrent())
+    {
+        throw std::bad_alloc();
+    }
+
     //  ׸Ʈ  -> compact ȣ
     compact();
 
     // compact  ٽ õ
-    for (Segment& segment : segments) {
+    for (auto& segment : activeSegments()) {
         try {
-            return segment.allocate(size);
+            return segment->allocate(size, alignment);
         }
         catch (const std::bad_alloc&) {
             continue;
@@ -37,11 +208,16 @@ void* MemoryPool::allocate(size_t size)
 
 void MemoryPool::deallocate(void* ptr)
 {
-    for (Segment& segment : segments)
+    if (statistics)
+    {
+        recordDeallocation();
+    }
+
+    for (auto& segment : activeSegments())
     {
         try
         {
-            segment.deallocate(ptr);
+            segment->deallocate(ptr);
             return;
         }
         catch (const std::invalid_argument&)
@@ -52,10 +228,314 @@ void MemoryPool::deallocate(void* ptr)
     throw std::invalid_argument("Pointer does not belong to any segment.");
 }
 
+void MemoryPool::deallocate(void* ptr, size_t size, size_t alignment)
+{
+    if (isConcurrent() && isCacheable(size, alignment))
+    {
+        if (statistics)
+        {
+            recordDeallocation();
+        }
+
+        deallocateCached(ptr, size, alignment);
+        return;
+    }
+
+    deallocate(ptr);
+}
+
 void MemoryPool::compact()
 {
-    for (Segment& segment : segments)
+    if (isConcurrent())
     {
-        segment.compact();
+        return;
     }
+
+    for (auto& segment : activeSegments())
+    {
+        segment->compact();
+    }
+}
+
+// Segments past scannedCount were added by other threads after the caller looked;
+// they are tried before reserving yet another one
+void* MemoryPool::grow(size_t size, size_t alignment, size_t scannedCount)
+{
+    std::lock_guard lock(growLock);
+
+    size_t count = segmentCount.load(std::memory_order_acquire);
+    for (size_t i = scannedCount; i < count; ++i)
+    {
+        try
+        {
+            return segments[i]->allocate(size, alignment);
+        }
+        catch (const std::bad_alloc&)
+        {
+            continue;
+        }
+    }
+
+    if (segments.size() == segments.capacity())
+    {
+        throw std::bad_alloc();
+    }
+
+    VirtualMemory::Placement placement;
+    placement.largePages = flags & MEMORY_POOL_FLAG_LARGE_PAGES;
+    placement.numaNode = (flags & MEMORY_POOL_FLAG_NUMA_LOCAL) ? LocalNumaNode() : VirtualMemory::ANY_NUMA_NODE;
+
+    // room for the worst case alignment padding of the request that didn't fit. Reservations
+    // double so a growing pool needs few segments; they cost address space, not memory
+    size_t reserveSize = std::max(growthSize, AlignUp(size + alignment, VirtualMemory::GetPageSize()));
+    growthSize = std::min(reserveSize * 2, MAX_GROWTH_SIZE);
+    segments.push_back(std::make_unique<Segment>(reserveSize, SegmentBacking::Virtual, placement));
+    segmentCount.store(segments.size(), std::memory_order_release);
+
+    return segments.back()->allocate(size, alignment);
+}
+
+std::span<const std::unique_ptr<Segment>> MemoryPool::activeSegments() const
+{
+    return { segments.data(), segmentCount.load(std::memory_order_acquire) };
+}
+
+void* MemoryPool::allocateCached(size_t size, size_t alignment)
+{
+    size_t sizeClass = sizeClassIndex(size, alignment);
+    ThreadCache& cache = getThreadCache();
+    ThreadCache::Magazine& magazine = cache.magazines[sizeClass];
+
+    if (magazine.count == 0)
+    {
+        refill(cache, sizeClass);
+    }
+
+    return magazine.blocks[--magazine.count];
+}
+
+// Blocks stay registered in their segment while they circulate through caches, so a block
+// freed on another thread simply lands in that thread's magazine and flows back via the depot.
+void MemoryPool::deallocateCached(void* ptr, size_t size, size_t alignment)
+{
+    size_t sizeClass = sizeClassIndex(size, alignment);
+    ThreadCache& cache = getThreadCache();
+    ThreadCache::Magazine& magazine = cache.magazines[sizeClass];
+
+    if (magazine.count == MAGAZINE_CAPACITY)
+    {
+        ThreadCache::flush(*depot, cache.shard, sizeClass, magazine, MAGAZINE_CAPACITY / 2);
+    }
+
+    magazine.blocks[magazine.count++] = ptr;
+}
+
+void MemoryPool::refill(ThreadCache& cache, size_t sizeClass)
+{
+    ThreadCache::Magazine& magazine = cache.magazines[sizeClass];
+    constexpr size_t refillCount = MAGAZINE_CAPACITY / 2;
+
+    // home shard first, then steal from the others
+    for (size_t i = 0; i < DEPOT_SHARD_COUNT && magazine.count == 0; ++i)
+    {
+        LockFreeFreeList& blocks = depot->shards[(cache.shard + i) % DEPOT_SHARD_COUNT].blocks[sizeClass];
+        while (magazine.count < refillCount)
+        {
+            void* block = blocks.Pop();
+            if (!block)
+            {
+                break;
+            }
+            magazine.blocks[magazine.count++] = block;
+        }
+    }
+
+    if (magazine.count)
+    {
+        return;
+    }
+
+    // depot is empty, carve a fresh batch out of the segments. Every block of a class is aligned
+    // to min(class size, cache line), which covers any alignment that maps to that class.
+    size_t blockSize = sizeClassSize(sizeClass);
+    size_t blockAlignment = std::min(blockSize, CACHE_LINE_SIZE);
+    magazine.blocks[magazine.count++] = allocateFromSegments(blockSize, blockAlignment);
+    try
+    {
+        while (magazine.count < refillCount)
+        {
+            magazine.blocks[magazine.count++] = allocateFromSegments(blockSize, blockAlignment);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        // a partial batch is fine as long as the first block was obtained
+    }
+}
+
+MemoryPool::ThreadCache& MemoryPool::getThreadCache()
+{
+    thread_local std::vector<std::unique_ptr<ThreadCache>> caches;
+
+    for (auto& cache : caches)
+    {
+        if (cache->poolId == poolId)
+        {
+            return *cache;
+        }
+    }
+
+    std::erase_if(caches, [](const std::unique_ptr<ThreadCache>& cache) { return cache->depot.expired(); });
+
+    auto cache = std::make_unique<ThreadCache>();
+    cache->poolId = poolId;
+    cache->shard = HomeShard();
+    cache->depot = depot;
+    caches.push_back(std::move(cache));
+
+    return *caches.back();
+}
+
+void MemoryPool::recordAllocation(size_t size)
+{
+    StatisticsShard& shard = statistics->shards[HomeShard()];
+
+    size_t bucket = std::min<size_t>(size > 1 ? std::bit_width(size - 1) : 0, HISTOGRAM_BUCKET_COUNT - 1);
+    shard.sizeHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    // only threads sharing a home shard (and getStatistics) ever contend here
+    std::string_view tag = MemoryTagScope::current();
+    SpinLock lock(shard.tagLock);
+    TagStatistics& tagStatistics = shard.tags[tag];
+    tagStatistics.tag = tag;
+    tagStatistics.allocations++;
+    tagStatistics.bytes += size;
+}
+
+void MemoryPool::recordDeallocation()
+{
+    statistics->shards[HomeShard()].deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+MemoryPool::Statistics MemoryPool::getStatistics() const
+{
+    Statistics result;
+    for (auto& segment : activeSegments())
+    {
+        result.segments.push_back(segment->getStatistics());
+    }
+
+    if (!statistics)
+    {
+        return result;
+    }
+
+    // the same tag may have been counted in several shards
+    std::unordered_map<std::string_view, TagStatistics> tags;
+    for (const StatisticsShard& shard : statistics->shards)
+    {
+        for (size_t i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i)
+        {
+            result.sizeHistogram[i] += shard.sizeHistogram[i].load(std::memory_order_relaxed);
+        }
+        result.allocations += shard.allocations.load(std::memory_order_relaxed);
+        result.deallocations += shard.deallocations.load(std::memory_order_relaxed);
+
+        SpinLock lock(shard.tagLock);
+        for (auto& [tag, tagStatistics] : shard.tags)
+        {
+            TagStatistics& merged = tags[tag];
+            merged.tag = tag;
+            merged.allocations += tagStatistics.allocations;
+            merged.bytes += tagStatistics.bytes;
+        }
+    }
+
+    for (auto& [tag, tagStatistics] : tags)
+    {
+        result.tags.push_back(tagStatistics);
+    }
+
+    std::sort(result.tags.begin(), result.tags.end(), [](const TagStatistics& a, const TagStatistics& b)
+        {
+            return a.bytes > b.bytes;
+        });
+
+    return result;
+}
+
+bool MemoryPool::dumpStatistics(const std::filesystem::path& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    Statistics result = getStatistics();
+
+    file << "[Segments]\n";
+    for (size_t i = 0; i < result.segments.size(); ++i)
+    {
+        const Segment::Statistics& segment = result.segments[i];
+        file << "segment " << i
+            << " total=" << segment.totalSize
+            << " used=" << segment.allocatedSize
+            << " free=" << segment.freeBytes()
+            << " live=" << segment.liveBytes
+            << " blocks=" << segment.liveBlocks
+            << " peak=" << segment.peakSize
+            << " committed=" << segment.committedSize
+            << " contentions=" << segment.lockContentions
+            << " node=" << segment.numaNode
+            << " largePages=" << segment.largePages
+            << " fragmentation=" << segment.fragmentation() << "\n";
+    }
+
+    if (!statistics)
+    {
+        return true;
+    }
+
+    file << "\n[Allocations]\nallocations=" << result.allocations << " deallocations=" << result.deallocations << "\n";
+
+    file << "\n[SizeHistogram]\n";
+    for (size_t i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        if (result.sizeHistogram[i])
+        {
+            file << "<=" << (size_t(1) << i) << " bytes: " << result.sizeHistogram[i] << "\n";
+        }
+    }
+
+    file << "\n[Tags]\n";
+    for (const TagStatistics& tag : result.tags)
+    {
+        file << tag.tag << " allocations=" << tag.allocations << " bytes=" << tag.bytes << "\n";
+    }
+
+    return true;
+}
+
+bool MemoryPool::isCacheable(size_t size, size_t alignment)
+{
+    return size <= MAX_CACHED_SIZE && alignment <= CACHE_LINE_SIZE;
+}
+
+size_t MemoryPool::sizeClassIndex(size_t size, size_t alignment)
+{
+    size = std::max(size, alignment);
+
+    if (size <= MIN_CACHED_SIZE)
+    {
+        return 0;
+    }
+
+    return std::bit_width(size - 1) - std::bit_width(MIN_CACHED_SIZE - 1);
+}
+
+size_t MemoryPool::sizeClassSize(size_t sizeClass)
+{
+    return MIN_CACHED_SIZE << sizeClass;
 }
@@ -1,17 +1,145 @@
 #pragma once
 #include "Segment.h"
+#include "LockFree.h"
 #include <vector>
+#include <array>
+#include <memory>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <span>
+#include <unordered_map>
+
+enum MEMORY_POOL_FLAG : unsigned int
+{
+    MEMORY_POOL_FLAG_NONE       = 0,
+    MEMORY_POOL_FLAG_CONCURRENT = 1 << 0, // per-thread caches in front of locked segments
+    MEMORY_POOL_FLAG_STATISTICS = 1 << 1, // size histogram and per-tag counters
+    MEMORY_POOL_FLAG_VIRTUAL    = 1 << 2, // segment sizes are reservations, pages commit on demand; the pool adds segments when full and never moves blocks
+    MEMORY_POOL_FLAG_LARGE_PAGES = 1 << 3, // large/huge pages when available, implies VIRTUAL
+    MEMORY_POOL_FLAG_NUMA_LOCAL = 1 << 4, // one set of segments per NUMA node, threads allocate from their own node; implies VIRTUAL
+};
+
+// Attributes allocations made on this thread to a tag while the scope is alive.
+// Only pools created with MEMORY_POOL_FLAG_STATISTICS record tags; the tag must have static storage.
+class MemoryTagScope
+{
+public:
+    explicit MemoryTagScope(const char* tag);
+    ~MemoryTagScope();
+
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+    static const char* current();
+
+private:
+    const char* previous;
+};
 
 class MemoryPool
 {
+public:
+    // small blocks (16 ~ 4096 bytes) are served from per-thread caches in concurrent mode
+    static constexpr size_t MIN_CACHED_SIZE = 16;
+    static constexpr size_t MAX_CACHED_SIZE = 4096;
+    static constexpr size_t SIZE_CLASS_COUNT = 9;
+    static constexpr size_t MAGAZINE_CAPACITY = 64;
+    static constexpr size_t DEPOT_SHARD_COUNT = 8;
+    // bucket i counts requests of (2^(i-1), 2^i] bytes
+    static constexpr size_t HISTOGRAM_BUCKET_COUNT = 32;
+    // segments a virtual pool may add on top of the ones it was created with
+    static constexpr size_t MAX_GROWN_SEGMENTS = 64;
+
+    struct TagStatistics
+    {
+        std::string_view tag;
+        uint64_t allocations{};
+        uint64_t bytes{};
+    };
+
+    struct Statistics
+    {
+        std::vector<Segment::Statistics> segments;
+        std::array<uint64_t, HISTOGRAM_BUCKET_COUNT> sizeHistogram{};
+        std::vector<TagStatistics> tags; // heaviest first
+        uint64_t allocations{};
+        uint64_t deallocations{};
+    };
+
 private:
-    std::vector<Segment> segments;
+    struct DepotShard
+    {
+        LockFreeFreeList blocks[SIZE_CLASS_COUNT];
+    };
+
+    // lock-free global free lists shared by every thread, sharded to spread CAS contention
+    struct Depot
+    {
+        std::array<DepotShard, DEPOT_SHARD_COUNT> shards;
+    };
+
+    struct ThreadCache;
+
+    // each thread counts into its home shard, so concurrent allocations
+    // share neither a lock nor a cache line; getStatistics merges them
+    struct alignas(CACHE_LINE_SIZE) StatisticsShard
+    {
+        std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKET_COUNT> sizeHistogram{};
+        std::atomic<uint64_t> allocations{};
+        std::atomic<uint64_t> deallocations{};
+        mutable std::atomic_flag tagLock{};
+        std::unordered_map<std::string_view, TagStatistics> tags;
+    };
+
+    struct StatisticsCounters
+    {
+        std::array<StatisticsShard, DEPOT_SHARD_COUNT> shards;
+    };
+
+    // capacity is reserved up front so growth never reallocates under readers;
+    // segmentCount publishes how many entries are constructed
+    std::vector<std::unique_ptr<Segment>> segments;
+    std::atomic<size_t> segmentCount{};
+    AdaptiveLock growLock;
+    size_t growthSize{};
+    std::shared_ptr<Depot> depot;
+    uint64_t poolId;
+    unsigned int flags;
+    std::unique_ptr<StatisticsCounters> statistics;
+    std::filesystem::path shutdownDumpPath;
 
 public:
-    explicit MemoryPool(const std::vector<size_t>& segmentSizes);
+    explicit MemoryPool(const std::vector<size_t>& segmentSizes, unsigned int flags = MEMORY_POOL_FLAG_NONE);
+    ~MemoryPool();
 
-    void* allocate(size_t size);
+    void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+    void* allocateIsolated(size_t size);
     void deallocate(void* ptr);
+    void deallocate(void* ptr, size_t size, size_t alignment = DEFAULT_ALIGNMENT);
     void compact();
 
+    bool isConcurrent() const { return flags & MEMORY_POOL_FLAG_CONCURRENT; }
+
+    // Segment numbers are always available; histogram and tags need MEMORY_POOL_FLAG_STATISTICS
+    Statistics getStatistics() const;
+    bool dumpStatistics(const std::filesystem::path& path) const;
+    void setDumpOnShutdown(const std::filesystem::path& path) { shutdownDumpPath = path; }
+
+private:
+    void* allocateFromSegments(size_t size, size_t alignment);
+    void* grow(size_t size, size_t alignment, size_t scannedCount);
+    std::span<const std::unique_ptr<Segment>> activeSegments() const;
+    void* allocateCached(size_t size, size_t alignment);
+    void deallocateCached(void* ptr, size_t size, size_t alignment);
+    void refill(ThreadCache& cache, size_t sizeClass);
+
+    ThreadCache& getThreadCache();
+
+    void recordAllocation(size_t size);
+    void recordDeallocation();
+
+    static bool isCacheable(size_t size, size_t alignment);
+    static size_t sizeClassIndex(size_t size, size_t alignment);
+    static size_t sizeClassSize(size_t sizeClass);
 };
@@ -0,0 +1,196 @@
+#pragma once
+#include <new>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <utility>
+
+// --------------------------------------------------------
+// 32-bit generational handle: 20 bits of slot index and
+// 12 bits of generation. A handle goes stale as soon as its
+// slot is destroyed, even if the slot is reused later.
+// Value 0 is never handed out and means "no object".
+// --------------------------------------------------------
+template <typename T>
+class Handle
+{
+public:
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+
+    Handle() = default;
+    Handle(uint32_t index, uint32_t generation) : value((generation << INDEX_BITS) | (index & INDEX_MASK)) {}
+
+    static Handle FromValue(uint32_t value)
+    {
+        Handle handle;
+        handle.value = value;
+        return handle;
+    }
+
+    uint32_t GetIndex() const { return value & INDEX_MASK; }
+    uint32_t GetGeneration() const { return value >> INDEX_BITS; }
+    uint32_t GetValue() const { return value; }
+
+    explicit operator bool() const { return value != 0; }
+    bool operator==(const Handle&) const = default;
+
+private:
+    uint32_t value{};
+};
+
+// --------------------------------------------------------
+// Typed pool with stable object addresses. Objects live in
+// fixed-size chunks that never move; a dense array of live
+// slots allows tight iteration without visiting holes.
+// Not thread-safe: create/destroy from the owning thread.
+// --------------------------------------------------------
+template <typename T, size_t ChunkSize = 256>
+class ObjectPool
+{
+private:
+    static constexpr uint32_t INVALID_DENSE = static_cast<uint32_t>(-1);
+
+    struct Chunk
+    {
+        alignas(T) unsigned char storage[sizeof(T) * ChunkSize];
+    };
+
+public:
+    ObjectPool() = default;
+    ~ObjectPool() { Clear(); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // If T's constructor throws, the pool is left as it was
+    template <typename... Args>
+    Handle<T> Create(Args&&... args)
+    {
+        // everything that can throw, apart from T, happens before a slot is taken
+        dense.reserve(dense.size() + 1);
+        if (freeSlots.empty())
+        {
+            AddSlot();
+        }
+
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        try
+        {
+            new (SlotPointer(index)) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            // fits, the pop above left the capacity
+            freeSlots.push_back(index);
+            throw;
+        }
+
+        denseIndices[index] = static_cast<uint32_t>(dense.size());
+        dense.push_back(index);
+
+        return Handle<T>(index, generations[index]);
+    }
+
+    void Destroy(Handle<T> handle)
+    {
+        if (!IsValid(handle))
+        {
+            return;
+        }
+
+        uint32_t index = handle.GetIndex();
+        SlotPointer(index)->~T();
+
+        // swap-remove from the dense list
+        uint32_t densePosition = denseIndices[index];
+        uint32_t lastSlot = dense.back();
+        dense[densePosition] = lastSlot;
+        denseIndices[lastSlot] = densePosition;
+        dense.pop_back();
+        denseIndices[index] = INVALID_DENSE;
+
+        // generation 0 is skipped so a live handle is never 0
+        uint32_t generation = (generations[index] + 1) & Handle<T>::GENERATION_MASK;
+        generations[index] = generation ? generation : 1;
+        freeSlots.push_back(index);
+    }
+
+    bool IsValid(Handle<T> handle) const
+    {
+        uint32_t index = handle.GetIndex();
+        return handle
+            && index < generations.size()
+            && generations[index] == handle.GetGeneration()
+            && denseIndices[index] != INVALID_DENSE;
+    }
+
+    T* Get(Handle<T> handle) const
+    {
+        return IsValid(handle) ? SlotPointer(handle.GetIndex()) : nullptr;
+    }
+
+    // Handle of the i-th live object in dense order (0 <= i < Size())
+    Handle<T> GetHandleAt(size_t denseIndex) const
+    {
+        uint32_t index = dense[denseIndex];
+        return Handle<T>(index, generations[index]);
+    }
+
+    size_t Size() const { return dense.size(); }
+
+    template <typename Func>
+    void ForEach(Func&& func)
+    {
+        for (uint32_t index : dense)
+        {
+            func(*SlotPointer(index));
+        }
+    }
+
+    void Clear()
+    {
+        while (!dense.empty())
+        {
+            Destroy(GetHandleAt(dense.size() - 1));
+        }
+    }
+
+private:
+    // Appends a free slot; grows every array first so a failure leaves them consistent
+    void AddSlot()
+    {
+        uint32_t index = static_cast<uint32_t>(generations.size());
+        if (index > Handle<T>::INDEX_MASK)
+        {
+            throw std::bad_alloc();
+        }
+
+        if (index / ChunkSize == chunks.size())
+        {
+            chunks.push_back(std::make_unique<Chunk>());
+        }
+        generations.reserve(index + 1);
+        denseIndices.reserve(index + 1);
+        freeSlots.reserve(freeSlots.size() + 1);
+
+        generations.push_back(1);
+        denseIndices.push_back(INVALID_DENSE);
+        freeSlots.push_back(index);
+    }
+
+    T* SlotPointer(uint32_t index) const
+    {
+        return reinterpret_cast<T*>(chunks[index / ChunkSize]->storage) + (index % ChunkSize);
+    }
+
+private:
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<uint16_t> generations;
+    std::vector<uint32_t> denseIndices; // slot -> position in dense, INVALID_DENSE when free
+    std::vector<uint32_t> dense;        // live slots
+    std::vector<uint32_t> freeSlots;
+};
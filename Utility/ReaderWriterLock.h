@@ -0,0 +1,159 @@
+#pragma once
+#include "CpuPause.h"
+#include "MemoryAlignment.h"
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------
+// Writer-preferring reader/writer lock in one 32-bit word.
+// Readers take it with a single CAS when no writer is
+// active or pending; a pending writer stops new readers so
+// it can't starve. Waiters spin with backoff, then park on
+// std::atomic::wait.
+// Satisfies SharedLockable: use with std::shared_lock /
+// std::unique_lock.
+// --------------------------------------------------------
+class ReaderWriterLock
+{
+private:
+    static constexpr uint32_t WRITER = 1u << 31;
+    static constexpr uint32_t WRITER_PENDING = 1u << 30;
+    static constexpr uint32_t READER_MASK = WRITER_PENDING - 1;
+
+public:
+    ReaderWriterLock() = default;
+    ReaderWriterLock(const ReaderWriterLock&) = delete;
+    ReaderWriterLock& operator=(const ReaderWriterLock&) = delete;
+
+    void lock_shared()
+    {
+        Backoff backoff;
+        while (true)
+        {
+            uint32_t current = state.load(std::memory_order_relaxed);
+            if (!(current & (WRITER | WRITER_PENDING)))
+            {
+                if (state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+                continue;
+            }
+            Wait(backoff, current);
+        }
+    }
+
+    bool try_lock_shared()
+    {
+        uint32_t current = state.load(std::memory_order_relaxed);
+        return !(current & (WRITER | WRITER_PENDING))
+            && state.compare_exchange_strong(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock_shared()
+    {
+        uint32_t previous = state.fetch_sub(1, std::memory_order_release);
+        if ((previous & READER_MASK) == 1 && (previous & WRITER_PENDING))
+        {
+            state.notify_all();
+        }
+    }
+
+    void lock()
+    {
+        Backoff backoff;
+        while (true)
+        {
+            uint32_t current = state.load(std::memory_order_relaxed);
+            if (!(current & (WRITER | READER_MASK)))
+            {
+                // clears WRITER_PENDING too; other waiting writers set it again
+                if (state.compare_exchange_weak(current, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+                continue;
+            }
+
+            if (!(current & WRITER_PENDING))
+            {
+                state.fetch_or(WRITER_PENDING, std::memory_order_relaxed);
+                continue;
+            }
+            Wait(backoff, current);
+        }
+    }
+
+    bool try_lock()
+    {
+        uint32_t current = state.load(std::memory_order_relaxed);
+        return !(current & (WRITER | READER_MASK))
+            && state.compare_exchange_strong(current, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock()
+    {
+        state.store(0, std::memory_order_release);
+        state.notify_all();
+    }
+
+private:
+    void Wait(Backoff& backoff, uint32_t observed)
+    {
+        if (backoff.IsSpinning())
+        {
+            backoff.Pause();
+        }
+        else
+        {
+            state.wait(observed, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> state{};
+};
+
+// --------------------------------------------------------
+// Lock striping for hash tables: a key's hash picks one of
+// ShardCount reader/writer locks, each on its own cache
+// line, so lookups in different buckets don't share a line.
+// LockAll/UnlockAll take every shard for table-wide changes
+// such as rehashing.
+// --------------------------------------------------------
+template <size_t ShardCount = 16>
+class ShardedReaderWriterLock
+{
+    static_assert(IsPowerOfTwo(ShardCount), "ShardCount must be a power of two");
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard
+    {
+        ReaderWriterLock lock;
+    };
+
+public:
+    ReaderWriterLock& GetShard(size_t hash)
+    {
+        return shards[hash & (ShardCount - 1)].lock;
+    }
+
+    void LockAll()
+    {
+        for (Shard& shard : shards)
+        {
+            shard.lock.lock();
+        }
+    }
+
+    void UnlockAll()
+    {
+        for (size_t i = ShardCount; i > 0; --i)
+        {
+            shards[i - 1].lock.unlock();
+        }
+    }
+
+private:
+    Shard shards[ShardCount];
+};
@@ -0,0 +1,52 @@
+#include "RingAllocator.h"
+#include <stdexcept>
+
+RingAllocator::RingAllocator(size_t capacity, uint32_t frameLatency)
+    : capacity(capacity), frameLatency(frameLatency)
+{
+    if (capacity == 0)
+    {
+        throw std::invalid_argument("RingAllocator needs a non-zero capacity.");
+    }
+}
+
+RingAllocator::Allocation RingAllocator::Allocate(size_t size, size_t alignment)
+{
+    if (size > capacity)
+    {
+        return {};
+    }
+
+    size_t ringOffset = head % capacity;
+    size_t offset = AlignUp(ringOffset, alignment);
+    size_t position = head + (offset - ringOffset);
+    if (offset + size > capacity)
+    {
+        // does not fit before the end, skip the rest and start over
+        offset = 0;
+        position = head + (capacity - ringOffset);
+    }
+
+    if (position + size - tail > capacity)
+    {
+        return {};
+    }
+
+    head = position + size;
+    return { offset, size, offset == 0 };
+}
+
+// --------------------------------------------------------
+// Closes the current frame and reclaims the space of the
+// frame that was written frameLatency frames ago. Must not
+// race with Allocate; call it from the frame loop only.
+// --------------------------------------------------------
+void RingAllocator::BeginFrame()
+{
+    frameEnds.push_back(head);
+    while (frameEnds.size() > frameLatency)
+    {
+        tail = frameEnds.front();
+        frameEnds.pop_front();
+    }
+}
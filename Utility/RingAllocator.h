@@ -0,0 +1,52 @@
+#pragma once
+#include "FrameListener.h"
+#include "MemoryAlignment.h"
+#include <deque>
+
+// --------------------------------------------------------
+// Offset allocator for a fixed-size ring, typically a GPU
+// buffer written by the CPU each frame. It hands out offsets
+// only; the memory itself belongs to the caller.
+// Space is reclaimed a whole frame at a time, frameLatency
+// frames after it was written, so nothing the GPU may still
+// read is overwritten. Not thread safe; use it from the
+// render thread.
+// --------------------------------------------------------
+class RingAllocator : public IFrameListener
+{
+public:
+    static constexpr uint32_t DEFAULT_FRAME_LATENCY = 3;
+    static constexpr size_t INVALID_OFFSET = SIZE_MAX;
+
+    struct Allocation
+    {
+        size_t offset{ INVALID_OFFSET };
+        size_t size{};
+        // starts at the beginning of the ring (first use or wrap around)
+        bool wrapped{};
+
+        bool IsValid() const { return offset != INVALID_OFFSET; }
+    };
+
+public:
+    explicit RingAllocator(size_t capacity, uint32_t frameLatency = DEFAULT_FRAME_LATENCY);
+
+    // Returns an invalid allocation when the ring is full of in-flight frames
+    Allocation Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+    void BeginFrame();
+    void OnFrameBegin(uint64_t) override { BeginFrame(); }
+
+    size_t GetCapacity() const { return capacity; }
+    size_t GetUsedBytes() const { return head - tail; }
+    uint32_t GetFrameLatency() const { return frameLatency; }
+
+private:
+    size_t capacity;
+    uint32_t frameLatency;
+    // head and tail only grow; the ring offset is position % capacity
+    size_t head{};
+    size_t tail{};
+    // head at the end of each frame still in flight, oldest first
+    std::deque<size_t> frameEnds;
+};
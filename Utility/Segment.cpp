@@ -1,10 +1,39 @@
 #include "Segment.h"
-#include "SpinLock.h"
+#include <mutex>
+#include "VirtualMemory.h"
+#include <algorithm>
 
-Segment::Segment(size_t size)
-    : totalSize(size), allocatedSize(0)
+namespace
 {
-    memoryBlock = std::malloc(size);
+    // commit in 64KB steps so a stream of small allocations doesn't make a syscall each
+    constexpr size_t COMMIT_GRANULARITY = 64 * 1024;
+}
+
+Segment::Segment(size_t size, SegmentBacking backing)
+    : Segment(size, backing, VirtualMemory::Placement{})
+{
+}
+
+Segment::Segment(size_t size, SegmentBacking backing, const VirtualMemory::Placement& placement)
+    : backing(backing), numaNode(placement.numaNode), totalSize(size), allocatedSize(0)
+{
+    if (backing == SegmentBacking::Virtual)
+    {
+        // page aligned, so it is cache line aligned as well
+        reservation = VirtualMemory::Reserve(size, placement);
+        memoryBlock = reservation.address;
+        if (reservation.committed)
+        {
+            committedSize = totalSize;
+        }
+    }
+    else
+    {
+        // segment base is cache line aligned so block alignment only depends on the padding we add
+        memoryBlock = AlignedMalloc(size, CACHE_LINE_SIZE);
+        committedSize = size;
+    }
+
     if (!memoryBlock)
     {
         throw std::bad_alloc();
@@ -14,18 +43,35 @@ Segment::Segment(size_t size)
 
 Segment::~Segment()
 {
-    std::free(memoryBlock);
+    if (backing == SegmentBacking::Virtual)
+    {
+        VirtualMemory::Release(memoryBlock, reservation.size);
+    }
+    else
+    {
+        AlignedFree(memoryBlock);
+    }
 }
 
-void* Segment::allocate(size_t size)
+void* Segment::allocate(size_t size, size_t alignment)
 {
-    // SpinLock lock(lockFlag);
+    std::lock_guard lock(segmentLock);
+
+    if (!IsPowerOfTwo(alignment))
+    {
+        throw std::invalid_argument("Alignment must be a power of two.");
+    }
+
+    char* alignedPointer = AlignPointer(nextPosPointer, alignment);
+    size_t padding = alignedPointer - nextPosPointer;
 
-    if (allocatedSize + size > totalSize)
+    if (allocatedSize + padding + size > totalSize)
     {
         throw std::bad_alloc();
     }
 
+    commitUpTo(allocatedSize + padding + size);
+
     size_t index;
     if (!freeIndices.empty())
     {
@@ -38,11 +84,13 @@ void* Segment::allocate(size_t size)
     }
 
     // Placement new
-    void* result = nextPosPointer;
-    nextPosPointer += size;
-    allocatedSize += size;
+    void* result = alignedPointer;
+    nextPosPointer = alignedPointer + size;
+    allocatedSize += padding + size;
+    liveBytes += size;
+    peakSize = std::max(peakSize, allocatedSize);
 
-    indexMap[result] = index;
+    indexMap[result] = { index, size, alignment };
     reverseIndexMap[index] = result;
 
     return result;
@@ -50,13 +98,14 @@ void* Segment::allocate(size_t size)
 
 void Segment::deallocate(void* ptr)
 {
-    //SpinLock lock(lockFlag);
+    std::lock_guard lock(segmentLock);
     if (indexMap.find(ptr) == indexMap.end())
     {
         throw std::invalid_argument("Invalid pointer deallocation.");
     }
 
-    size_t index = indexMap[ptr];
+    size_t index = indexMap[ptr].index;
+    liveBytes -= indexMap[ptr].size;
     freeIndices.push_back(index);
     indexMap.erase(ptr);
     reverseIndexMap.erase(index);
@@ -64,44 +113,119 @@ void Segment::deallocate(void* ptr)
 
 void Segment::compact()
 {
-    // SpinLock lock(lockFlag);
+    std::lock_guard lock(segmentLock);
+
+    // virtual segments promise stable addresses; only a freed tail is given back
+    if (backing == SegmentBacking::Virtual)
+    {
+        char* end = static_cast<char*>(memoryBlock);
+        for (auto& [ptr, info] : indexMap)
+        {
+            end = std::max(end, static_cast<char*>(ptr) + info.size);
+        }
+
+        nextPosPointer = end;
+        allocatedSize = end - static_cast<char*>(memoryBlock);
+        decommitUnused();
+        return;
+    }
+
+    // blocks must slide down in address order or memmove would overwrite live data
+    std::vector<std::pair<void*, BlockInfo>> blocks(indexMap.begin(), indexMap.end());
+    std::sort(blocks.begin(), blocks.end(), [](const auto& a, const auto& b)
+        {
+            return a.first < b.first;
+        });
+
     char* compactedPointer = static_cast<char*>(memoryBlock);
+    std::unordered_map<void*, BlockInfo> newIndexMap;
     std::unordered_map<size_t, void*> newReverseIndexMap;
 
-    for (auto& entry : indexMap)
+    for (auto& [oldPtr, info] : blocks)
     {
-        void* oldPtr = entry.first;
-        size_t index = entry.second;
-        size_t blockSize = nextPosPointer - static_cast<char*>(oldPtr);
+        compactedPointer = AlignPointer(compactedPointer, info.alignment);
 
-        std::memmove(compactedPointer, oldPtr, blockSize);
-        newReverseIndexMap[index] = compactedPointer;
+        std::memmove(compactedPointer, oldPtr, info.size);
+        newIndexMap[compactedPointer] = info;
+        newReverseIndexMap[info.index] = compactedPointer;
 
-        indexMap[compactedPointer] = index;
-        compactedPointer += blockSize;
+        compactedPointer += info.size;
     }
 
+    indexMap = std::move(newIndexMap);
     reverseIndexMap = std::move(newReverseIndexMap);
     nextPosPointer = compactedPointer;
     allocatedSize = compactedPointer - static_cast<char*>(memoryBlock);
+
+    decommitUnused();
+}
+
+Segment::Statistics Segment::getStatistics() const
+{
+    std::lock_guard lock(segmentLock);
+
+    Statistics statistics;
+    statistics.totalSize = totalSize;
+    statistics.allocatedSize = allocatedSize;
+    statistics.liveBytes = liveBytes;
+    statistics.liveBlocks = indexMap.size();
+    statistics.peakSize = peakSize;
+    statistics.committedSize = committedSize;
+    statistics.numaNode = numaNode;
+    statistics.largePages = reservation.largePages;
+    statistics.lockContentions = segmentLock.GetStatistics().contended;
+    return statistics;
 }
 
 size_t Segment::getIndex(void* ptr) const
 {
-    // SpinLock lock(lockFlag);
+    std::lock_guard lock(segmentLock);
     if (indexMap.find(ptr) == indexMap.end())
     {
         throw std::invalid_argument("Pointer not found.");
     }
-    return indexMap.at(ptr);
+    return indexMap.at(ptr).index;
 }
 
 void* Segment::getPointer(size_t index) const
 {
-    // SpinLock lock(lockFlag);
+    std::lock_guard lock(segmentLock);
     if (reverseIndexMap.find(index) == reverseIndexMap.end())
     {
         throw std::invalid_argument("Invalid index.");
     }
     return reverseIndexMap.at(index);
 }
+
+void Segment::commitUpTo(size_t size)
+{
+    if (size <= committedSize)
+    {
+        return;
+    }
+
+    size_t newCommittedSize = std::min(AlignUp(size, COMMIT_GRANULARITY), totalSize);
+    char* commitStart = static_cast<char*>(memoryBlock) + committedSize;
+    if (!VirtualMemory::Commit(commitStart, newCommittedSize - committedSize))
+    {
+        throw std::bad_alloc();
+    }
+    committedSize = newCommittedSize;
+}
+
+// Hands pages past the bump position back to the OS; their addresses stay reserved
+void Segment::decommitUnused()
+{
+    // explicit large pages are locked in memory for the life of the segment
+    if (backing != SegmentBacking::Virtual || reservation.committed)
+    {
+        return;
+    }
+
+    size_t keepSize = std::min(AlignUp(allocatedSize, COMMIT_GRANULARITY), totalSize);
+    if (keepSize < committedSize)
+    {
+        VirtualMemory::Decommit(static_cast<char*>(memoryBlock) + keepSize, committedSize - keepSize);
+        committedSize = keepSize;
+    }
+}
@@ -6,26 +6,81 @@
 #include <cstring>
 #include <cstdlib>
 #include <atomic>
+#include "MemoryAlignment.h"
+#include "AdaptiveLock.h"
+#include "VirtualMemory.h"
+
+enum class SegmentBacking
+{
+    Heap,    // whole segment is malloc'd up front
+    Virtual, // address range is reserved, pages are committed as the segment fills; blocks never move
+};
 
 class Segment
 {
+public:
+    struct Statistics
+    {
+        size_t totalSize{};
+        size_t allocatedSize{}; // bump position, includes padding and freed holes
+        size_t liveBytes{};
+        size_t liveBlocks{};
+        size_t peakSize{};
+        size_t committedSize{};
+        uint64_t lockContentions{};
+        int numaNode{ VirtualMemory::ANY_NUMA_NODE };
+        bool largePages{};
+
+        size_t freeBytes() const { return totalSize - allocatedSize; }
+        // share of the consumed range that is padding or freed holes only compact() can reclaim
+        double fragmentation() const { return allocatedSize ? 1.0 - static_cast<double>(liveBytes) / allocatedSize : 0.0; }
+    };
+
 private:
+    struct BlockInfo
+    {
+        size_t index;
+        size_t size;
+        size_t alignment;
+    };
+
     void* memoryBlock;
+    SegmentBacking backing;
+    VirtualMemory::Reservation reservation;
+    int numaNode{ VirtualMemory::ANY_NUMA_NODE };
     size_t totalSize;
+    size_t committedSize{};
     size_t allocatedSize;
+    size_t liveBytes{};
+    size_t peakSize{};
     char* nextPosPointer;
-    std::unordered_map<void*, size_t> indexMap;
+    std::unordered_map<void*, BlockInfo> indexMap;
     std::unordered_map<size_t, void*> reverseIndexMap;
     std::vector<size_t> freeIndices;
+    mutable AdaptiveLock segmentLock;
 
 public:
-    explicit Segment(size_t size);
+    explicit Segment(size_t size, SegmentBacking backing = SegmentBacking::Heap);
+    // placement only applies to virtual segments
+    Segment(size_t size, SegmentBacking backing, const VirtualMemory::Placement& placement);
     ~Segment();
 
-    void* allocate(size_t size);
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+
+    void* allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
     void deallocate(void* ptr);
+    // heap segments slide live blocks down; virtual segments never move a block
+    // and only rewind past blocks freed at the end
     void compact();
 
+    Statistics getStatistics() const;
+    int getNumaNode() const { return numaNode; }
+
     size_t getIndex(void* ptr) const;
     void* getPointer(size_t index) const;
+
+private:
+    void commitUpTo(size_t size);
+    void decommitUnused();
 };
@@ -0,0 +1,260 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+// --------------------------------------------------------
+// Vector with the first N elements stored inline; it only
+// touches the heap once it grows past N. Meant for short
+// lists that are rebuilt often (temporaries, per-shader
+// binding lists). Moving an inline SmallVector moves its
+// elements, so iterators do not survive a move.
+// --------------------------------------------------------
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(N > 0, "use std::vector when there is no inline capacity");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+public:
+    SmallVector() = default;
+
+    SmallVector(std::initializer_list<T> values)
+    {
+        assign(values.begin(), values.end());
+    }
+
+    template <typename InputIt>
+    SmallVector(InputIt first, InputIt last)
+    {
+        assign(first, last);
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        assign(other.begin(), other.end());
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        MoveFrom(other);
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        if (!IsInline())
+        {
+            Deallocate(_data);
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            clear();
+            if (!IsInline())
+            {
+                Deallocate(_data);
+                _data = Inline();
+                _capacity = N;
+            }
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first)
+        {
+            new (_data + _size) T(*first);
+            ++_size;
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (_size < _capacity)
+        {
+            T* element = new (_data + _size) T(std::forward<Args>(args)...);
+            ++_size;
+            return *element;
+        }
+
+        // args may refer to an element of this vector (v.push_back(v[0])), so the new
+        // element is built in the new buffer before the old one is moved from and freed
+        size_t capacity = std::max<size_t>(_capacity * 2, 1);
+        T* data = Allocate(capacity);
+        T* element;
+        try
+        {
+            element = new (data + _size) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            Deallocate(data);
+            throw;
+        }
+
+        Adopt(data, capacity);
+        ++_size;
+        return *element;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        _data[--_size].~T();
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return erase(position, position + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        T* begin = _data + (first - _data);
+        T* end = _data + (last - _data);
+        T* newEnd = std::move(end, _data + _size, begin);
+        std::destroy(newEnd, _data + _size);
+        _size = static_cast<size_t>(newEnd - _data);
+        return begin;
+    }
+
+    void resize(size_t count)
+    {
+        reserve(count);
+        while (_size < count)
+        {
+            new (_data + _size) T();
+            ++_size;
+        }
+        while (_size > count)
+        {
+            pop_back();
+        }
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity > _capacity)
+        {
+            Grow(capacity);
+        }
+    }
+
+    void clear()
+    {
+        std::destroy(_data, _data + _size);
+        _size = 0;
+    }
+
+    T& operator[](size_t index) { return _data[index]; }
+    const T& operator[](size_t index) const { return _data[index]; }
+
+    T& front() { return _data[0]; }
+    T& back() { return _data[_size - 1]; }
+    const T& front() const { return _data[0]; }
+    const T& back() const { return _data[_size - 1]; }
+
+    T* data() { return _data; }
+    const T* data() const { return _data; }
+
+    iterator begin() { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+    bool empty() const { return _size == 0; }
+
+private:
+    T* Inline() { return std::launder(reinterpret_cast<T*>(_inline)); }
+    bool IsInline() const { return _data == reinterpret_cast<const T*>(_inline); }
+
+    static T* Allocate(size_t capacity)
+    {
+        return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    static void Deallocate(T* data)
+    {
+        ::operator delete(data, std::align_val_t(alignof(T)));
+    }
+
+    void Grow(size_t capacity)
+    {
+        capacity = std::max<size_t>(capacity, 1);
+        Adopt(Allocate(capacity), capacity);
+    }
+
+    // moves the elements into data, which becomes the buffer
+    void Adopt(T* data, size_t capacity)
+    {
+        std::uninitialized_move(_data, _data + _size, data);
+        std::destroy(_data, _data + _size);
+
+        if (!IsInline())
+        {
+            Deallocate(_data);
+        }
+        _data = data;
+        _capacity = capacity;
+    }
+
+    // expects this to be empty and inline
+    void MoveFrom(SmallVector& other)
+    {
+        if (other.IsInline())
+        {
+            std::uninitialized_move(other._data, other._data + other._size, _data);
+            _size = other._size;
+            other.clear();
+        }
+        else
+        {
+            // heap buffers are stolen outright
+            _data = other._data;
+            _size = other._size;
+            _capacity = other._capacity;
+            other._data = other.Inline();
+            other._size = 0;
+            other._capacity = N;
+        }
+    }
+
+private:
+    T* _data{ Inline() };
+    size_t _size{};
+    size_t _capacity{ N };
+    alignas(T) std::byte _inline[sizeof(T) * N];
+};
@@ -1,6 +1,6 @@
 #pragma once
 #include <atomic>
-#include <immintrin.h> // For _mm_pause
+#include "CpuPause.h"
 
 template <typename T>
 class SpinLock
@@ -13,7 +13,7 @@ public:
     {
         while (m_lock.test_and_set(std::memory_order_acquire))
         {
-            _mm_pause();
+            CpuPause();
         }
     }
 
@@ -0,0 +1,68 @@
+#include "StackAllocator.h"
+#include <algorithm>
+
+StackAllocator::StackAllocator(size_t chunkSize)
+    : chunkSize(chunkSize)
+{
+    AddChunk(chunkSize);
+}
+
+StackAllocator::~StackAllocator()
+{
+    for (Chunk& chunk : chunks)
+    {
+        AlignedFree(chunk.memory);
+    }
+}
+
+void* StackAllocator::Allocate(size_t size, size_t alignment)
+{
+    while (true)
+    {
+        Chunk& chunk = chunks[currentChunk];
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.memory);
+        size_t alignedOffset = AlignUp(base + offset, alignment) - base;
+
+        if (alignedOffset + size <= chunk.capacity)
+        {
+            offset = alignedOffset + size;
+            return chunk.memory + alignedOffset;
+        }
+
+        // move on to the next chunk, growing the chain if the cached ones are too small
+        if (currentChunk + 1 == chunks.size() || chunks[currentChunk + 1].capacity < size + alignment)
+        {
+            AddChunk(size + alignment);
+        }
+
+        currentChunk++;
+        offset = 0;
+    }
+}
+
+void StackAllocator::RewindTo(const Marker& marker)
+{
+    currentChunk = marker.chunk;
+    offset = marker.offset;
+}
+
+StackAllocator& StackAllocator::ThreadLocal()
+{
+    thread_local StackAllocator allocator;
+    return allocator;
+}
+
+void StackAllocator::AddChunk(size_t minimumSize)
+{
+    Chunk chunk;
+    chunk.capacity = std::max(chunkSize, AlignUp(minimumSize, CACHE_LINE_SIZE));
+    chunk.memory = static_cast<char*>(AlignedMalloc(chunk.capacity, CACHE_LINE_SIZE));
+    if (!chunk.memory)
+    {
+        throw std::bad_alloc();
+    }
+
+    // keep chunk order matching the LIFO chain: insert right after the current one
+    size_t position = chunks.empty() ? 0 : currentChunk + 1;
+    chunks.insert(chunks.begin() + position, chunk);
+}
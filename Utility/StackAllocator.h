@@ -0,0 +1,86 @@
+#pragma once
+#include "MemoryAlignment.h"
+#include <memory>
+#include <vector>
+
+// --------------------------------------------------------
+// LIFO scratch allocator for temporaries that die in the
+// reverse order they were made (file loading, reflection).
+// Grab a Marker, allocate, then RewindTo the marker - or use
+// StackAllocatorScope to do the rewind automatically.
+// When a chunk runs out a new one is chained on, so a large
+// request never fails; chunks are kept for reuse.
+// --------------------------------------------------------
+class StackAllocator
+{
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+    struct Marker
+    {
+        size_t chunk{};
+        size_t offset{};
+    };
+
+private:
+    struct Chunk
+    {
+        char* memory{};
+        size_t capacity{};
+    };
+
+public:
+    explicit StackAllocator(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~StackAllocator();
+
+    StackAllocator(const StackAllocator&) = delete;
+    StackAllocator& operator=(const StackAllocator&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+    // Storage is default-initialized, intended for trivial types
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        T* result = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        std::uninitialized_default_construct_n(result, count);
+        return result;
+    }
+
+    Marker GetMarker() const { return { currentChunk, offset }; }
+    void RewindTo(const Marker& marker);
+    void Reset() { RewindTo({}); }
+
+    // Per-thread instance, safe to use from any worker without locking
+    static StackAllocator& ThreadLocal();
+
+private:
+    void AddChunk(size_t minimumSize);
+
+private:
+    size_t chunkSize;
+    size_t currentChunk{};
+    size_t offset{};
+    std::vector<Chunk> chunks;
+};
+
+// Rewinds the allocator to where it was when the scope was entered
+class StackAllocatorScope
+{
+public:
+    explicit StackAllocatorScope(StackAllocator& allocator = StackAllocator::ThreadLocal())
+        : allocator(allocator), marker(allocator.GetMarker()) {}
+    ~StackAllocatorScope() { allocator.RewindTo(marker); }
+
+    StackAllocatorScope(const StackAllocatorScope&) = delete;
+    StackAllocatorScope& operator=(const StackAllocatorScope&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT) { return allocator.Allocate(size, alignment); }
+
+    template <typename T>
+    T* AllocateArray(size_t count) { return allocator.AllocateArray<T>(count); }
+
+private:
+    StackAllocator& allocator;
+    StackAllocator::Marker marker;
+};
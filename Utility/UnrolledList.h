@@ -0,0 +1,274 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Embedded in elements that an UnrolledList links: where the
+// element's pointer sits, so Unlink doesn't have to search
+struct UnrolledListHook
+{
+    void* chunk{};
+    uint32_t slot{};
+
+    bool IsLinked() const { return chunk != nullptr; }
+};
+
+// --------------------------------------------------------
+// Intrusive unrolled list: pointers to the elements live in
+// 64-slot chunks with an occupancy mask, so iteration walks
+// contiguous memory and skips holes with a bit scan instead
+// of chasing a node pointer per element. Elements embed an
+// UnrolledListHook and stay where their owner put them; the
+// list never copies, owns or destroys one. Link/Unlink are
+// O(1). Link refills holes left by Unlink first, so
+// iteration order is not insertion order once elements have
+// been removed.
+//
+//   struct Item { UnrolledListHook visible; ... };
+//   UnrolledList<Item, &Item::visible> list;
+//   list.Link(item);
+// --------------------------------------------------------
+template <typename T, UnrolledListHook T::*Hook, size_t ChunkSize = 64>
+class UnrolledList
+{
+    static_assert(ChunkSize > 0 && ChunkSize <= 64, "occupancy is tracked in a 64-bit mask");
+
+    static constexpr uint64_t FULL_MASK = ChunkSize == 64 ? ~0ull : (1ull << ChunkSize) - 1;
+
+    struct Chunk
+    {
+        T* slots[ChunkSize]{};
+        uint64_t occupied{};
+        Chunk* prev{};
+        Chunk* next{};
+        // chunks with free slots form a second list that Link draws from
+        Chunk* prevPartial{};
+        Chunk* nextPartial{};
+        bool partial{};
+    };
+
+public:
+    class Iterator
+    {
+    public:
+        Iterator(Chunk* chunk) : _chunk(chunk) { SkipEmpty(); }
+
+        Iterator& operator++()
+        {
+            _remaining &= _remaining - 1;
+            if (!_remaining)
+            {
+                _chunk = _chunk->next;
+                SkipEmpty();
+            }
+            return *this;
+        }
+
+        T& operator*() const { return *_chunk->slots[std::countr_zero(_remaining)]; }
+        T* operator->() const { return _chunk->slots[std::countr_zero(_remaining)]; }
+        bool operator!=(const Iterator& other) const { return _chunk != other._chunk || _remaining != other._remaining; }
+
+    private:
+        void SkipEmpty()
+        {
+            while (_chunk && !_chunk->occupied)
+            {
+                _chunk = _chunk->next;
+            }
+            _remaining = _chunk ? _chunk->occupied : 0;
+        }
+
+        Chunk* _chunk{};
+        uint64_t _remaining{};
+    };
+
+public:
+    UnrolledList() = default;
+    ~UnrolledList()
+    {
+        ClearLink();
+        while (_spare)
+        {
+            Chunk* next = _spare->next;
+            delete _spare;
+            _spare = next;
+        }
+    }
+
+    UnrolledList(const UnrolledList&) = delete;
+    UnrolledList& operator=(const UnrolledList&) = delete;
+
+    Iterator begin() { return Iterator(_head); }
+    Iterator end() { return Iterator(nullptr); }
+
+    // Does nothing if the element is already linked
+    void Link(T& element)
+    {
+        UnrolledListHook& hook = element.*Hook;
+        if (hook.IsLinked())
+        {
+            return;
+        }
+
+        if (!_partialHead)
+        {
+            AppendChunk();
+        }
+
+        Chunk* chunk = _partialHead;
+        uint32_t slot = static_cast<uint32_t>(std::countr_one(chunk->occupied));
+        chunk->slots[slot] = &element;
+        chunk->occupied |= 1ull << slot;
+        if (chunk->occupied == FULL_MASK)
+        {
+            RemovePartial(chunk);
+        }
+
+        hook.chunk = chunk;
+        hook.slot = slot;
+        ++_size;
+    }
+
+    void Unlink(T& element)
+    {
+        UnrolledListHook& hook = element.*Hook;
+        Chunk* chunk = static_cast<Chunk*>(hook.chunk);
+        if (!chunk)
+        {
+            return;
+        }
+
+        chunk->slots[hook.slot] = nullptr;
+        chunk->occupied &= ~(1ull << hook.slot);
+        hook = UnrolledListHook{};
+        --_size;
+
+        if (!chunk->partial)
+        {
+            AddPartial(chunk);
+        }
+
+        // keep one chunk around so a list that oscillates around empty does not churn the heap
+        if (!chunk->occupied && _head != _tail)
+        {
+            RemovePartial(chunk);
+            RemoveChunk(chunk);
+            chunk->next = _spare;
+            _spare = chunk;
+        }
+    }
+
+    bool IsLinked(const T& element) const { return (element.*Hook).IsLinked(); }
+
+    template <typename Func>
+    void ForEach(Func&& func)
+    {
+        for (Chunk* chunk = _head; chunk; chunk = chunk->next)
+        {
+            for (uint64_t mask = chunk->occupied; mask; mask &= mask - 1)
+            {
+                func(*chunk->slots[std::countr_zero(mask)]);
+            }
+        }
+    }
+
+    // Unlinks everything; the elements are left alone
+    void ClearLink()
+    {
+        Chunk* chunk = _head;
+        while (chunk)
+        {
+            Chunk* next = chunk->next;
+            for (uint64_t mask = chunk->occupied; mask; mask &= mask - 1)
+            {
+                chunk->slots[std::countr_zero(mask)]->*Hook = UnrolledListHook{};
+            }
+            chunk->next = _spare;
+            _spare = chunk;
+            chunk = next;
+        }
+
+        _head = _tail = nullptr;
+        _partialHead = nullptr;
+        _size = 0;
+    }
+
+    size_t Size() const { return _size; }
+    bool Empty() const { return _size == 0; }
+
+private:
+    void AppendChunk()
+    {
+        Chunk* chunk = _spare;
+        if (chunk)
+        {
+            _spare = chunk->next;
+        }
+        else
+        {
+            chunk = new Chunk;
+        }
+
+        chunk->occupied = 0;
+        chunk->prev = _tail;
+        chunk->next = nullptr;
+        chunk->prevPartial = chunk->nextPartial = nullptr;
+        chunk->partial = false;
+
+        if (_tail)
+        {
+            _tail->next = chunk;
+        }
+        else
+        {
+            _head = chunk;
+        }
+        _tail = chunk;
+
+        AddPartial(chunk);
+    }
+
+    void RemoveChunk(Chunk* chunk)
+    {
+        (chunk->prev ? chunk->prev->next : _head) = chunk->next;
+        (chunk->next ? chunk->next->prev : _tail) = chunk->prev;
+    }
+
+    void AddPartial(Chunk* chunk)
+    {
+        chunk->partial = true;
+        chunk->prevPartial = nullptr;
+        chunk->nextPartial = _partialHead;
+        if (_partialHead)
+        {
+            _partialHead->prevPartial = chunk;
+        }
+        _partialHead = chunk;
+    }
+
+    void RemovePartial(Chunk* chunk)
+    {
+        if (chunk->prevPartial)
+        {
+            chunk->prevPartial->nextPartial = chunk->nextPartial;
+        }
+        else
+        {
+            _partialHead = chunk->nextPartial;
+        }
+
+        if (chunk->nextPartial)
+        {
+            chunk->nextPartial->prevPartial = chunk->prevPartial;
+        }
+
+        chunk->partial = false;
+    }
+
+private:
+    Chunk* _head{};
+    Chunk* _tail{};
+    Chunk* _partialHead{};
+    Chunk* _spare{};
+    size_t _size{};
+};
@@ -0,0 +1,269 @@
+#include "VirtualMemory.h"
+#include "MemoryAlignment.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#endif
+
+namespace
+{
+#ifndef _WIN32
+    // from <linux/mempolicy.h>, which is not always installed
+    constexpr int MPOL_PREFERRED_POLICY = 1;
+
+    size_t ReadHugePageSize()
+    {
+        FILE* file = fopen("/proc/meminfo", "r");
+        if (!file)
+        {
+            return 0;
+        }
+
+        size_t sizeKb = 0;
+        char line[256];
+        while (fgets(line, sizeof(line), file))
+        {
+            if (sscanf(line, "Hugepagesize: %zu kB", &sizeKb) == 1)
+            {
+                break;
+            }
+        }
+        fclose(file);
+        return sizeKb * 1024;
+    }
+
+    void BindToNode(void* address, size_t size, int node)
+    {
+#ifdef SYS_mbind
+        if (node < 0 || node >= 64)
+        {
+            return;
+        }
+        unsigned long nodeMask = 1ul << node;
+        // best effort: without NUMA support the pages simply land wherever the kernel likes
+        syscall(SYS_mbind, address, size, MPOL_PREFERRED_POLICY, &nodeMask, sizeof(nodeMask) * 8, 0);
+#else
+        (void)address;
+        (void)size;
+        (void)node;
+#endif
+    }
+#else
+    // large pages need SeLockMemoryPrivilege; enabled on the process token by the first large page reservation
+    bool EnableLockMemoryPrivilege()
+    {
+        HANDLE token{};
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+        {
+            return false;
+        }
+
+        TOKEN_PRIVILEGES privileges{};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        bool enabled = LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+            && AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr)
+            && GetLastError() == ERROR_SUCCESS;
+
+        CloseHandle(token);
+        return enabled;
+    }
+
+    bool HasLockMemoryPrivilege()
+    {
+        static const bool enabled = EnableLockMemoryPrivilege();
+        return enabled;
+    }
+#endif
+}
+
+namespace VirtualMemory
+{
+    size_t GetPageSize()
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info{};
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    size_t GetLargePageSize()
+    {
+#ifdef _WIN32
+        static const size_t largePageSize = GetLargePageMinimum();
+#else
+        static const size_t largePageSize = ReadHugePageSize();
+#endif
+        return largePageSize;
+    }
+
+    int GetNumaNodeCount()
+    {
+#ifdef _WIN32
+        ULONG highestNode = 0;
+        return GetNumaHighestNodeNumber(&highestNode) ? static_cast<int>(highestNode) + 1 : 1;
+#else
+        static const int nodeCount = []()
+            {
+                int count = 0;
+                std::error_code error;
+                while (std::filesystem::exists("/sys/devices/system/node/node" + std::to_string(count), error))
+                {
+                    ++count;
+                }
+                return count ? count : 1;
+            }();
+        return nodeCount;
+#endif
+    }
+
+    int GetCurrentNumaNode()
+    {
+#ifdef _WIN32
+        PROCESSOR_NUMBER processor{};
+        GetCurrentProcessorNumberEx(&processor);
+        USHORT node = 0;
+        return GetNumaProcessorNodeEx(&processor, &node) ? node : 0;
+#elif defined(SYS_getcpu)
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<int>(node) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    void* Reserve(size_t size)
+    {
+#ifdef _WIN32
+        return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+        void* address = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return address == MAP_FAILED ? nullptr : address;
+#endif
+    }
+
+    Reservation Reserve(size_t size, const Placement& placement)
+    {
+        Reservation reservation;
+        size_t largePageSize = placement.largePages ? GetLargePageSize() : 0;
+
+#ifdef _WIN32
+        DWORD node = placement.numaNode >= 0 ? static_cast<DWORD>(placement.numaNode) : NUMA_NO_PREFERRED_NODE;
+
+        // only callers that ask for large pages change the process token
+        if (largePageSize && HasLockMemoryPrivilege())
+        {
+            // large pages cannot be committed lazily, the whole range is committed and locked here
+            size_t largeSize = AlignUp(size, largePageSize);
+            reservation.address = VirtualAllocExNuma(GetCurrentProcess(), nullptr, largeSize,
+                MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+            if (reservation.address)
+            {
+                reservation.size = largeSize;
+                reservation.committed = true;
+                reservation.largePages = true;
+                return reservation;
+            }
+        }
+
+        reservation.address = VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE, PAGE_NOACCESS, node);
+        reservation.size = size;
+#else
+        if (largePageSize)
+        {
+            // explicit huge pages only work when the admin has set some aside (vm.nr_hugepages)
+            size_t largeSize = AlignUp(size, largePageSize);
+            void* address = mmap(nullptr, largeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (address != MAP_FAILED)
+            {
+                BindToNode(address, largeSize, placement.numaNode);
+                reservation.address = address;
+                reservation.size = largeSize;
+                reservation.committed = true;
+                reservation.largePages = true;
+                return reservation;
+            }
+        }
+
+        reservation.address = Reserve(size);
+        reservation.size = size;
+        if (reservation.address)
+        {
+            BindToNode(reservation.address, size, placement.numaNode);
+            if (placement.largePages)
+            {
+                // fall back to transparent huge pages, applied as the range gets committed
+                reservation.largePages = AdviseHugePages(reservation.address, size);
+            }
+        }
+#endif
+        return reservation;
+    }
+
+    bool Commit(void* address, size_t size)
+    {
+#ifdef _WIN32
+        return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+        return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+    }
+
+    void Decommit(void* address, size_t size)
+    {
+#ifdef _WIN32
+        VirtualFree(address, size, MEM_DECOMMIT);
+#else
+        // drop the physical pages first so RSS actually shrinks
+        madvise(address, size, MADV_DONTNEED);
+        mprotect(address, size, PROT_NONE);
+#endif
+    }
+
+    void Release(void* address, size_t size)
+    {
+#ifdef _WIN32
+        VirtualFree(address, 0, MEM_RELEASE);
+#else
+        munmap(address, size);
+#endif
+    }
+
+    bool AdviseHugePages(void* address, size_t size)
+    {
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+        // madvise wants page aligned ranges; only whole huge pages inside the range can be promoted anyway
+        size_t largePageSize = GetLargePageSize();
+        if (!largePageSize)
+        {
+            return false;
+        }
+
+        char* begin = AlignPointer(static_cast<char*>(address), largePageSize);
+        char* end = static_cast<char*>(address) + size;
+        if (end - begin < static_cast<ptrdiff_t>(largePageSize))
+        {
+            return false;
+        }
+
+        size_t length = (static_cast<size_t>(end - begin) / largePageSize) * largePageSize;
+        return madvise(begin, length, MADV_HUGEPAGE) == 0;
+#else
+        (void)address;
+        (void)size;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+
+// --------------------------------------------------------
+// Thin wrapper over VirtualAlloc / mmap: reserve an address
+// range up front, then commit and decommit pages inside it.
+// Committed pages are zero-filled and read/write.
+// --------------------------------------------------------
+namespace VirtualMemory
+{
+    constexpr int ANY_NUMA_NODE = -1;
+
+    struct Placement
+    {
+        bool largePages{};              // explicit large pages if the OS grants them, else transparent huge pages
+        int numaNode{ ANY_NUMA_NODE };  // preferred node for the physical pages
+    };
+
+    struct Reservation
+    {
+        void* address{};
+        size_t size{};      // may be rounded up to the large page size
+        bool committed{};   // explicit large pages are committed (and locked) up front
+        bool largePages{};
+    };
+
+    size_t GetPageSize();
+    // 0 when the OS does not support large pages. Only a query: the privilege
+    // Windows needs for them is enabled by the first large page Reserve
+    size_t GetLargePageSize();
+
+    int GetNumaNodeCount();
+    // node of the processor the calling thread is running on, 0 when unknown
+    int GetCurrentNumaNode();
+
+    void* Reserve(size_t size);
+    // Falls back to a plain reservation when large pages or the node are unavailable
+    Reservation Reserve(size_t size, const Placement& placement);
+    bool Commit(void* address, size_t size);
+    void Decommit(void* address, size_t size);
+    void Release(void* address, size_t size);
+
+    // Hints that a reserved range should be backed by transparent huge pages; no-op where unsupported
+    bool AdviseHugePages(void* address, size_t size);
+}
@@ -0,0 +1,74 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(&WorkerPool::Run, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::Submit(Task task)
+{
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void WorkerPool::WaitIdle()
+{
+    std::unique_lock lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && running == 0; });
+}
+
+void WorkerPool::Run()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty())
+        {
+            // stopping, and nothing left to run
+            return;
+        }
+
+        Task task = std::move(tasks.front());
+        tasks.pop_front();
+        ++running;
+
+        lock.unlock();
+        task();
+        // destroy the callable (and whatever it holds) outside the lock
+        task = nullptr;
+        lock.lock();
+
+        if (--running == 0 && tasks.empty())
+        {
+            idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "InplaceFunction.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------
+// Fixed set of threads running submitted tasks in FIFO
+// order. Meant for blocking work (file reads, parsing) off
+// the main thread, not for fine grained parallel loops.
+// Submit may be called from any thread, including a task.
+// --------------------------------------------------------
+class WorkerPool
+{
+public:
+    using Task = InplaceFunction<void(), 48>;
+
+public:
+    // threadCount 0 uses one thread per core but the caller's
+    explicit WorkerPool(uint32_t threadCount = 0);
+    // Runs every task already submitted, then joins
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void Submit(Task task);
+
+    // Blocks until the queue is empty and no task is running
+    void WaitIdle();
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(threads.size()); }
+
+private:
+    void Run();
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Task> tasks;
+    uint32_t running{};
+    bool stopping{};
+
+    std::vector<std::thread> threads;
+};